@@ -0,0 +1,82 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Arenas and pools of fixed size blocks. Arena chunks come zeroed from calloc, and since an arena never
+// reuses memory before it is released, every allocation from it is zeroed too.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "arena.h"
+
+arena_t nodeArena = { NULL, 0 };
+
+// Function to allocate bytes of zeroed memory aligned to ARENA_ALIGN from arena, adding a chunk if the current one is
+// too full
+void* arenaAlloc(arena_t* arena, size_t bytes)
+{
+	arenaChunk_t* chunk = arena->head;
+	size_t header = (sizeof(arenaChunk_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	size_t offset = 0;
+	if (chunk != NULL)
+	{
+		// Offset of next aligned address in chunk, counted from end of header
+		uintptr_t start = (uintptr_t)chunk + header;
+		offset = ((start + chunk->used + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1)) - start;
+	}
+	if (chunk == NULL || offset + bytes > chunk->size)
+	{
+		// Large allocations get a chunk of their own size, with room to align it
+		size_t size = bytes + ARENA_ALIGN > ARENA_CHUNK ? bytes + ARENA_ALIGN : ARENA_CHUNK;
+		chunk = (arenaChunk_t*)calloc(1, header + size);
+		if (chunk == NULL)
+		{
+			perror("calloc arena chunk");
+			exit(1);
+		}
+		chunk->next = arena->head;
+		chunk->size = size;
+		chunk->used = 0;
+		arena->head = chunk;
+		uintptr_t start = (uintptr_t)chunk + header;
+		offset = ((start + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1)) - start;
+	}
+	chunk->used = offset + bytes;
+	arena->bytes += bytes;
+	return (char*)chunk + header + offset;
+}
+
+// Function to free every chunk of arena, leaving it empty for reuse
+void arenaRelease(arena_t* arena)
+{
+	arenaChunk_t* chunk = arena->head;
+	while (chunk != NULL)
+	{
+		arenaChunk_t* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	arena->head = NULL;
+	arena->bytes = 0;
+}
+
+// Function to set up empty pool of blocks of blockSize bytes, taken from arena
+void poolInit(pool_t* pool, size_t blockSize, arena_t* arena)
+{
+	pool->blockSize = blockSize < sizeof(void*) ? sizeof(void*) : blockSize;
+	pool->freeList = NULL;
+	pool->arena = arena;
+	pool->inUse = 0;
+}
+
+// Function to take a chunk of POOL_CHUNK_BLOCKS blocks from pool's arena and put them on its free list, lowest first
+void poolGrow(pool_t* pool)
+{
+	char* chunk = (char*)arenaAlloc(pool->arena, pool->blockSize * POOL_CHUNK_BLOCKS);
+	for (int i = POOL_CHUNK_BLOCKS - 1; i >= 0; i--)
+	{
+		void* block = chunk + i * pool->blockSize;
+		*(void**)block = pool->freeList;
+		pool->freeList = block;
+	}
+}
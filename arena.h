@@ -0,0 +1,123 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Memory used by oss without calling the heap on every reference. An arena hands out zeroed, cache line
+// aligned memory from large chunks and is released all at once, so the tables of a run are allocated together and
+// freed together. A pool hands out blocks of one size, refilling its free list from an arena a chunk of blocks at a
+// time, and poolAllocator lets the node containers of the replacement policies take their nodes from such a pool.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <new>
+
+#define ARENA_ALIGN 64 // Alignment of every arena allocation, the size of a cache line
+#define ARENA_CHUNK (1 << 20) // Default bytes of each chunk an arena allocates
+#define POOL_CHUNK_BLOCKS 64 // Blocks a pool takes from its arena at once when its free list is empty
+
+// Structure for the header at the start of every chunk of an arena
+typedef struct arenaChunk
+{
+	struct arenaChunk* next; // Chunk allocated before this one, NULL if first
+	size_t size; // Bytes in chunk after header
+	size_t used; // Bytes handed out from chunk
+} arenaChunk_t;
+
+// Structure for an arena
+typedef struct
+{
+	arenaChunk_t* head; // Chunk allocations are made from, NULL if none allocated
+	size_t bytes; // Bytes handed out since arena was last released
+} arena_t;
+
+// Structure for a pool of blocks of one size. Free blocks hold the next free block in their first bytes.
+typedef struct
+{
+	size_t blockSize; // Bytes in each block, at least the size of a pointer
+	void* freeList; // First free block, NULL if every block taken is in use
+	arena_t* arena; // Arena chunks of blocks are taken from
+	long long inUse; // Blocks currently handed out
+} pool_t;
+
+void* arenaAlloc(arena_t* arena, size_t bytes);
+void arenaRelease(arena_t* arena);
+void poolInit(pool_t* pool, size_t blockSize, arena_t* arena);
+void poolGrow(pool_t* pool);
+
+// Function to allocate zeroed array of n values of type T from arena
+template <typename T>
+static inline T* arenaArray(arena_t* arena, size_t n)
+{
+	return (T*)arenaAlloc(arena, n * sizeof(T));
+}
+
+// Function to take a block from pool, growing it from its arena if no block is free
+static inline void* poolTake(pool_t* pool)
+{
+	if (pool->freeList == NULL)
+		poolGrow(pool);
+	void* block = pool->freeList;
+	pool->freeList = *(void**)block;
+	pool->inUse++;
+	return block;
+}
+
+// Function to return block to pool
+static inline void poolGive(pool_t* pool, void* block)
+{
+	*(void**)block = pool->freeList;
+	pool->freeList = block;
+	pool->inUse--;
+}
+
+// Arena node pools of every poolAllocator draw from, kept until the process exits since containers may outlive a run
+extern arena_t nodeArena;
+
+// Allocator for node based containers. Single nodes come from a pool of nodes of that type, so once a container has
+// reached its largest size, inserting and erasing no longer calls the heap. Arrays, such as hash buckets, are rare
+// and come from the heap.
+template <typename T>
+struct poolAllocator
+{
+	typedef T value_type;
+
+	poolAllocator() {}
+	template <typename U> poolAllocator(const poolAllocator<U>&) {}
+
+	// Function to get pool of nodes of type T, set up on first use
+	static pool_t* nodePool()
+	{
+		static pool_t pool = { sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T), NULL, &nodeArena, 0 };
+		return &pool;
+	}
+
+	T* allocate(size_t n)
+	{
+		if (n == 1)
+			return (T*)poolTake(nodePool());
+		return (T*)::operator new(n * sizeof(T));
+	}
+
+	void deallocate(T* p, size_t n)
+	{
+		if (n == 1)
+			poolGive(nodePool(), p);
+		else
+			::operator delete(p);
+	}
+};
+
+template <typename T, typename U>
+static inline bool operator==(const poolAllocator<T>&, const poolAllocator<U>&)
+{
+	return true;
+}
+
+template <typename T, typename U>
+static inline bool operator!=(const poolAllocator<T>&, const poolAllocator<U>&)
+{
+	return false;
+}
+
+#endif
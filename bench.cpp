@@ -0,0 +1,236 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Microbenchmarks of the paging core, driven in-process with Google Benchmark instead of through oss and
+// its workers. Each benchmark sets up the pager for one replacement policy and frame count, with one process whose
+// address space is twice the size of memory, and reports time per reference for hits, faults taken into a free frame,
+// faults that evict a frame, and the mixed streams of each reference generator. The clock is advanced by the same cost
+// oss adds for a hit, so policies that look at reference times see them move. Run ./bench --help for the options of
+// Google Benchmark, such as --benchmark_filter=evict/lru to run a subset.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "pager.h"
+#include "pagetable.h"
+#include "simclock.h"
+#include "counters.h"
+#include "refgen.h"
+#include "log.h"
+
+#define BENCH_MIN_FRAMES 256 // Smallest frame count benchmarked
+#define BENCH_MAX_FRAMES (1 << 20) // Largest frame count benchmarked
+#define BENCH_PAGE_SIZE 1024 // Page size of benchmarked process
+#define BENCH_PID 1 // PID of benchmarked process
+
+// Clock and counters normally in shared memory, kept in this process since nothing else reads them
+static simClock_t benchClock;
+static ossCounters_t benchCounters;
+simClock_t* simClock = &benchClock;
+ossCounters_t* counters = &benchCounters;
+
+// Policies benchmarked, every policy except opt, which needs the future of a recorded trace
+static const char* benchPolicies[] = { "lru", "clock", "second", "eclock", "lruscan", "arc" };
+
+// Generator specs benchmarked with mixed streams
+static const char* benchGens[] = { "uniform", "zipf", "seq", "stride", "phase" };
+
+// Page table kinds benchmarked with lookups
+static const int benchTables[] = { PT_FLAT, PT_RADIX, PT_HASH };
+
+// Function to set up pager for policy with frames frames and one process of twice as many pages in slot 0
+static void benchSetup(const char* name, int frames, int kind = PT_FLAT)
+{
+	pageTableKind = kind;
+	policy = findPolicy(name);
+	clockSet(0);
+	pagerInit(1, frames, frames * 2, BENCH_PAGE_SIZE);
+	slotBind(slotAlloc(), BENCH_PID);
+}
+
+// Function to load page of process in slot 0, as oss does once a fault's latency has passed
+static int benchFault(unsigned page, bool isWrite)
+{
+	processTable[0].waitPage = page;
+	processTable[0].waitIsWrite = isWrite;
+	return pageFault(0);
+}
+
+// Function to fill every frame with the first frameNum pages
+static void benchFill()
+{
+	for (int page = 0; page < frameNum; page++)
+	{
+		benchFault(page, false);
+	}
+}
+
+// Function to benchmark hits on resident pages picked uniformly
+static void benchHit(benchmark::State& state, const char* name)
+{
+	benchSetup(name, state.range(0));
+	benchFill();
+	refConfig_t cfg;
+	refParse("uniform", &cfg);
+	refConfigure(&cfg, BENCH_PAGE_SIZE, frameNum, DEF_WRITE_PCT);
+	refState_t st;
+	refInit(&st, BENCH_PID, 0, &cfg);
+	unsigned address;
+	bool isWrite;
+	for (auto _ : state)
+	{
+		refNext(&st, &address, &isWrite);
+		clockAdd(1100);
+		pageHit(0, ptGet(0, address / BENCH_PAGE_SIZE), isWrite);
+	}
+	state.SetItemsProcessed(state.iterations());
+	pagerFree();
+}
+
+// Function to benchmark faults into a free frame, releasing the process's frames whenever memory fills
+static void benchFaultFree(benchmark::State& state, const char* name)
+{
+	benchSetup(name, state.range(0));
+	int page = 0;
+	for (auto _ : state)
+	{
+		if (freeTop == 0)
+		{
+			state.PauseTiming();
+			releaseProcess(0);
+			page = 0;
+			state.ResumeTiming();
+		}
+		clockAdd(1100);
+		benchmark::DoNotOptimize(benchFault(page++, false));
+	}
+	state.SetItemsProcessed(state.iterations());
+	pagerFree();
+}
+
+// Function to benchmark faults that evict a frame, walking the address space for the next page not resident
+static void benchFaultEvict(benchmark::State& state, const char* name)
+{
+	benchSetup(name, state.range(0));
+	benchFill();
+	unsigned page = frameNum;
+	for (auto _ : state)
+	{
+		while (ptGet(0, page) != -1)
+		{
+			page = (page + 1) % pageCount;
+		}
+		clockAdd(1100);
+		benchmark::DoNotOptimize(benchFault(page, (page & 1) != 0));
+	}
+	state.SetItemsProcessed(state.iterations());
+	pagerFree();
+}
+
+// Function to benchmark stream of a reference generator through full memory, hits and faults alike
+static void benchStream(benchmark::State& state, const char* name, const char* gen)
+{
+	benchSetup(name, state.range(0));
+	benchFill();
+	refConfig_t cfg;
+	refParse(gen, &cfg);
+	refConfigure(&cfg, BENCH_PAGE_SIZE, pageCount, DEF_WRITE_PCT);
+	refState_t st;
+	refInit(&st, BENCH_PID, 0, &cfg);
+	unsigned address;
+	bool isWrite;
+	long long faults = 0;
+	for (auto _ : state)
+	{
+		refNext(&st, &address, &isWrite);
+		clockAdd(1100);
+		int frame = ptGet(0, address / BENCH_PAGE_SIZE);
+		if (frame != -1)
+			pageHit(0, frame, isWrite);
+		else
+		{
+			faults++;
+			benchFault(address / BENCH_PAGE_SIZE, isWrite);
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.counters["faultRate"] = benchmark::Counter((double)faults / state.iterations());
+	pagerFree();
+}
+
+// Function to benchmark page table lookups of resident pages picked uniformly, with memory full
+static void benchLookup(benchmark::State& state, int kind)
+{
+	benchSetup("lru", state.range(0), kind);
+	benchFill();
+	refConfig_t cfg;
+	refParse("uniform", &cfg);
+	refConfigure(&cfg, BENCH_PAGE_SIZE, frameNum, DEF_WRITE_PCT);
+	refState_t st;
+	refInit(&st, BENCH_PID, 0, &cfg);
+	unsigned address;
+	bool isWrite;
+	for (auto _ : state)
+	{
+		refNext(&st, &address, &isWrite);
+		benchmark::DoNotOptimize(ptGet(0, address / BENCH_PAGE_SIZE));
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.counters["tableBytes"] = benchmark::Counter((double)ptPeakBytes);
+	pagerFree();
+}
+
+// Function to benchmark push and pop of the wait queue holding depth processes
+static void benchWaitQueue(benchmark::State& state)
+{
+	waitQueue_t queue;
+	long long now = 0;
+	for (int i = 0; i < state.range(0); i++)
+	{
+		queue.push(waitEntry_t(now + (i * 7919) % 15000000, i));
+	}
+	for (auto _ : state)
+	{
+		// Complete earliest fault and queue a new one, keeping depth the same
+		waitEntry_t top = queue.top();
+		queue.pop();
+		now = top.first;
+		queue.push(waitEntry_t(now + 14000000 + (top.second * 7919) % 1000000, top.second));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+int main(int argc, char* argv[])
+{
+	// Only final statistics level output, so swaps are not printed
+	logLevel = LOG_STATS;
+
+	for (const char* name : benchPolicies)
+	{
+		benchmark::RegisterBenchmark((std::string("hit/") + name).c_str(), benchHit, name)
+			->RangeMultiplier(4)->Range(BENCH_MIN_FRAMES, BENCH_MAX_FRAMES);
+		benchmark::RegisterBenchmark((std::string("faultFree/") + name).c_str(), benchFaultFree, name)
+			->RangeMultiplier(4)->Range(BENCH_MIN_FRAMES, BENCH_MAX_FRAMES);
+		benchmark::RegisterBenchmark((std::string("evict/") + name).c_str(), benchFaultEvict, name)
+			->RangeMultiplier(4)->Range(BENCH_MIN_FRAMES, BENCH_MAX_FRAMES);
+		for (const char* gen : benchGens)
+		{
+			benchmark::RegisterBenchmark((std::string("stream/") + name + "/" + gen).c_str(), benchStream, name, gen)
+				->RangeMultiplier(4)->Range(BENCH_MIN_FRAMES, BENCH_MAX_FRAMES);
+		}
+	}
+	for (int kind : benchTables)
+	{
+		benchmark::RegisterBenchmark((std::string("lookup/") + ptName(kind)).c_str(), benchLookup, kind)
+			->RangeMultiplier(4)->Range(BENCH_MIN_FRAMES, BENCH_MAX_FRAMES);
+	}
+	benchmark::RegisterBenchmark("waitQueue", benchWaitQueue)->RangeMultiplier(4)->Range(1, 1024);
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,63 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Counters oss keeps on its own work, in a shared memory page so another program can read them while oss
+// runs. Only the main thread of oss writes the counters, so each update is a plain load and store of an atomic instead
+// of a locked add, and a reader always sees whole values. Times are in processor timestamp counter cycles, with the
+// counter and real time both read at startup so a reader can convert cycles to time.
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <atomic>
+#include <sys/types.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define CTR_MAGIC 0x5352544e43535346ULL // Marks a segment set up by this version
+#define CTR_PROJ 3 // ftok project id of counters segment, keyed on msgq.txt like the message queue
+
+// Structure held in counters shared memory segment
+typedef struct
+{
+	unsigned long long magic; // CTR_MAGIC once segment is set up
+	pid_t pid; // PID of oss writing the counters
+	unsigned long long startTsc; // Timestamp counter at startup
+	long long startWallNs; // Real time at startup, from CLOCK_MONOTONIC
+
+	std::atomic<unsigned long long> iterations; // Main loop iterations, or events in discrete event mode
+	std::atomic<unsigned long long> drained; // Worker messages received
+	std::atomic<unsigned long long> idleSpins; // Iterations that received no message and completed no fault
+	std::atomic<unsigned long long> rcvEmpty; // Times a nonblocking receive found nothing, ENOMSG from msgrcv
+	std::atomic<unsigned long long> victims; // Frames evicted by the replacement policy
+	std::atomic<unsigned long long> scanFrames; // Frames examined by the policy to choose those victims
+	std::atomic<unsigned long long> replaceCycles; // Cycles spent servicing page faults in pageFault
+	std::atomic<unsigned long long> printCalls; // Calls to printInfo
+	std::atomic<unsigned long long> printCycles; // Cycles spent in printInfo
+	std::atomic<unsigned long long> reapCalls; // Times finished workers were reaped
+	std::atomic<unsigned long long> reapCycles; // Cycles spent reaping in waitpid
+} ossCounters_t;
+
+extern ossCounters_t* counters; // Attached counters segment, defined in oss.cpp
+
+// Function to add n to counter written only by the main thread of oss
+static inline void counterAdd(std::atomic<unsigned long long>* ctr, unsigned long long n)
+{
+	ctr->store(ctr->load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Function to read timestamp counter, or real time in ns on processors without one
+static inline unsigned long long counterCycles()
+{
+#if defined(__x86_64__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+#endif
@@ -0,0 +1,115 @@
+#!/bin/bash
+# Operating Systems Project 6
+# Author: Maija Garson
+# Date: 05/15/2025
+# Description: End-to-end throughput harness. Runs oss once for every combination of the given process totals,
+# simultaneous limits, launch intervals and transports, and writes a results table with the real time, CPU time and
+# context switches of each run and its references per second of real and system time. The watchdog of oss is off by
+# default so long runs finish, and a run the watchdog ends early is marked truncated from its exit status.
+
+usage()
+{
+	echo "usage: $0 [-h] [-n \"procs\"] [-s \"simuls\"] [-i \"intervals\"] [-t \"transports\"] [-a seconds] [-o file] [-- ossOptions]"
+	echo "      procs, simuls and intervals are space separated values of oss options n, s and i to run (default \"$PROCS\", \"$SIMULS\", \"$INTERVALS\")"
+	echo "      transports are values of oss option t to run, msgq and ring (default \"$TRANSPORTS\")"
+	echo "      seconds is the watchdog of each run, 0 for none (default $WATCHDOG)"
+	echo "      file is the CSV file results are written to (default $OUT)"
+	echo "      ossOptions are passed to every run, for example -- -d -p clock"
+}
+
+# Default matrix
+PROCS="10 50"
+SIMULS="2 8"
+INTERVALS="0 10"
+TRANSPORTS="msgq ring"
+WATCHDOG=0
+OUT="harnessResults.csv"
+EXIT_TRUNCATED=3 # Exit status of oss when its watchdog ended the run
+
+while getopts "hn:s:i:t:a:o:" opt
+do
+	case $opt in
+		h) usage; exit 0 ;;
+		n) PROCS="$OPTARG" ;;
+		s) SIMULS="$OPTARG" ;;
+		i) INTERVALS="$OPTARG" ;;
+		t) TRANSPORTS="$OPTARG" ;;
+		a) WATCHDOG="$OPTARG" ;;
+		o) OUT="$OPTARG" ;;
+		*) usage; exit 1 ;;
+	esac
+done
+shift $((OPTIND - 1))
+EXTRA="$*"
+
+# oss launches ./worker and keys its IPC on files in its own directory
+cd "$(dirname "$0")" || exit 1
+if [ ! -x ./oss ] || [ ! -x ./worker ]
+then
+	echo "Error! Build oss and worker with make first." >&2
+	exit 1
+fi
+
+# Function to pull the first number after a label out of a run's output
+field()
+{
+	awk -v label="$1" 'index($0, label) == 1 { sub(label, ""); print $1 + 0; exit }' "$LOG"
+}
+
+# Function to pull the number before a word out of a line of a run's output, skipping a unit of seconds
+before()
+{
+	awk -v label="$1" -v word="$2" 'index($0, label) == 1 { for (i = 2; i <= NF; i++) if ($i ~ word) { v = $(i - 1); if (v == "s") v = $(i - 2); print v + 0; exit } }' "$LOG"
+}
+
+LOG=$(mktemp)
+trap 'rm -f "$LOG"' EXIT
+echo "transport,n,s,i,status,wallSec,userSec,sysSec,volCsw,involCsw,refs,refsPerWallSec,refsPerSimSec" > "$OUT"
+
+for t in $TRANSPORTS
+do
+	for n in $PROCS
+	do
+		for s in $SIMULS
+		do
+			for i in $INTERVALS
+			do
+				start=$(date +%s.%N)
+				./oss -v 0 -a "$WATCHDOG" -t "$t" -n "$n" -s "$s" -i "$i" $EXTRA > "$LOG" 2>&1
+				code=$?
+				end=$(date +%s.%N)
+				wall=$(echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }')
+
+				if [ $code -eq 0 ]
+				then
+					status=ok
+				elif [ $code -eq $EXIT_TRUNCATED ]
+				then
+					status=truncated
+				else
+					status=error
+				fi
+
+				# Statistics are only printed by runs that finished
+				if [ $status = ok ]
+				then
+					user=$(before "CPU time:" "user")
+					sys=$(before "CPU time:" "system")
+					vol=$(before "Context switches:" "^voluntary")
+					invol=$(before "Context switches:" "involuntary")
+					refs=$(field "Total memory references:")
+					wallRate=$(field "References per sec of real time:")
+					simRate=$(field "References per sec of system time:")
+				else
+					user=; sys=; vol=; invol=; refs=; wallRate=; simRate=
+				fi
+				echo "$t,$n,$s,$i,$status,$wall,$user,$sys,$vol,$invol,$refs,$wallRate,$simRate" >> "$OUT"
+				echo "$t n=$n s=$s i=$i: $status in $wall s" >&2
+			done
+		done
+	done
+done
+
+# Print results as aligned table
+awk -F, '{ for (c = 1; c <= NF; c++) { cell[NR, c] = $c; if (length($c) > width[c]) width[c] = length($c) } cols[NR] = NF }
+	END { for (r = 1; r <= NR; r++) { for (c = 1; c <= cols[r]; c++) printf "%-*s  ", width[c], cell[r, c]; printf "\n" } }' "$OUT"
@@ -0,0 +1,306 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Large page bookkeeping and the buddy allocator of free frames. Each order has a list of free runs of
+// 2^order frames, linked through arrays indexed by the first frame of each run, and the order of the run each free frame
+// starts is kept so a freed frame can tell whether its buddy is free without searching. Frames beyond the last whole run
+// of the largest order start out in smaller runs. Which regions of each PCB slot are mapped as large pages, how often
+// each was referenced since it last changed, and which were ever promoted are kept per slot and region.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "huge.h"
+#include "pager.h"
+
+long long hugePromotions = 0;
+long long hugeDemotions = 0;
+long long hugeFaults = 0;
+long long hugeCopies = 0;
+long long hugeNoRun = 0;
+int hugeMapped = 0;
+int hugePeakMapped = 0;
+
+static hugeConfig_t hugeCfg = { 0, DEF_HUGE_HOT_REFS }; // Settings in use
+static arena_t hugeArena = { NULL, 0 }; // Arena the buddy lists and region tables are allocated from
+static int buddyHead[MAX_HUGE_ORDER + 1]; // First free run of each order, -1 if none
+static int* buddyPrev = NULL; // Previous free run in the list of the same order, -1 if first
+static int* buddyNext = NULL; // Next free run in the list of the same order, -1 if last
+static signed char* buddyOrder = NULL; // Order of the free run each frame starts, -1 if it starts none
+static unsigned long long* hugeLargeBits = NULL; // Bit set for each frame in the run of a mapped large page
+static int hugeRegions = 0; // Whole regions in each address space
+static int* regionRun = NULL; // First frame of large page mapping each region of each slot, -1 if none
+static int* regionRefs = NULL; // References to each region of each slot since it was last promoted or demoted
+static unsigned long long* regionPromoted = NULL; // Bit set for each region of each slot promoted since the process started
+
+// Function to parse large page spec into cfg, returns false if spec is not valid
+bool hugeParse(const char* spec, hugeConfig_t* cfg)
+{
+	char* end;
+	if (*spec < '0' || *spec > '9')
+		return false;
+	long order = strtol(spec, &end, 10);
+	if (order < 1 || order > MAX_HUGE_ORDER)
+		return false;
+	cfg->order = order;
+	cfg->hotRefs = DEF_HUGE_HOT_REFS;
+	if (*end == '\0')
+		return true;
+	if (*end != ':' || end[1] < '0' || end[1] > '9')
+		return false;
+	long refs = strtol(end + 1, &end, 10);
+	cfg->hotRefs = refs;
+	return *end == '\0' && refs >= 1 && refs <= 1000000;
+}
+
+// Function to add free run starting at frame to the front of the list of its order
+static void buddyPush(int frame, int order)
+{
+	buddyOrder[frame] = order;
+	buddyPrev[frame] = -1;
+	buddyNext[frame] = buddyHead[order];
+	if (buddyHead[order] != -1)
+		buddyPrev[buddyHead[order]] = frame;
+	buddyHead[order] = frame;
+}
+
+// Function to remove free run starting at frame from the list of its order
+static void buddyUnlink(int frame)
+{
+	int order = buddyOrder[frame];
+	if (buddyPrev[frame] != -1)
+		buddyNext[buddyPrev[frame]] = buddyNext[frame];
+	else
+		buddyHead[order] = buddyNext[frame];
+	if (buddyNext[frame] != -1)
+		buddyPrev[buddyNext[frame]] = buddyPrev[frame];
+	buddyOrder[frame] = -1;
+}
+
+// Function to use large pages with settings in cfg. Called after pagerInit, while every frame is free, and splits the
+// frame table into the largest aligned runs that fit.
+void hugeInit(const hugeConfig_t* cfg)
+{
+	hugeCfg = *cfg;
+	arenaRelease(&hugeArena);
+	hugePromotions = 0;
+	hugeDemotions = 0;
+	hugeFaults = 0;
+	hugeCopies = 0;
+	hugeNoRun = 0;
+	hugeMapped = 0;
+	hugePeakMapped = 0;
+	hugeLargeBits = NULL;
+	if (hugeCfg.order == 0)
+		return;
+
+	buddyPrev = arenaArray<int>(&hugeArena, frameNum);
+	buddyNext = arenaArray<int>(&hugeArena, frameNum);
+	buddyOrder = arenaArray<signed char>(&hugeArena, frameNum);
+	hugeLargeBits = arenaArray<unsigned long long>(&hugeArena, (frameNum + 63) / 64);
+	memset(buddyOrder, 0xff, frameNum);
+	for (int k = 0; k <= MAX_HUGE_ORDER; k++)
+	{
+		buddyHead[k] = -1;
+	}
+	// Cut frames into the largest aligned runs that fit, pushing the last run first so the lowest frame heads its list
+	int largest = 1 << hugeCfg.order;
+	int whole = frameNum & ~(largest - 1);
+	int end = frameNum;
+	for (int k = 0; k < hugeCfg.order; k++)
+	{
+		if ((frameNum - whole) & (1 << k))
+		{
+			end -= 1 << k;
+			buddyPush(end, k);
+		}
+	}
+	for (int frame = whole - largest; frame >= 0; frame -= largest)
+	{
+		buddyPush(frame, hugeCfg.order);
+	}
+
+	hugeRegions = pageCount >> hugeCfg.order;
+	regionRun = arenaArray<int>(&hugeArena, (size_t)maxProc * hugeRegions);
+	regionRefs = arenaArray<int>(&hugeArena, (size_t)maxProc * hugeRegions);
+	regionPromoted = arenaArray<unsigned long long>(&hugeArena, ((size_t)maxProc * hugeRegions + 63) / 64);
+	memset(regionRun, 0xff, (size_t)maxProc * hugeRegions * sizeof(int));
+}
+
+// Function to check if large pages are used
+bool hugeEnabled()
+{
+	return hugeCfg.order > 0;
+}
+
+// Function to get amount of base pages in a large page as a power of two
+int hugeOrder()
+{
+	return hugeCfg.order;
+}
+
+// Function to get amount of base pages in a large page
+int hugePages()
+{
+	return 1 << hugeCfg.order;
+}
+
+// Function to take a free run of 2^order frames, splitting the smallest larger run if none of that order is free.
+// Returns first frame of the run, -1 if no run that large is free.
+int buddyTake(int order)
+{
+	int k = order;
+	while (k <= hugeCfg.order && buddyHead[k] == -1)
+	{
+		k++;
+	}
+	if (k > hugeCfg.order)
+		return -1;
+	int run = buddyHead[k];
+	buddyUnlink(run);
+	// Keep lower half of each split, returning the upper half to the list one order down
+	while (k > order)
+	{
+		k--;
+		buddyPush(run + (1 << k), k);
+	}
+	return run;
+}
+
+// Function to return a single frame to the allocator, merging it with its buddy for as long as the buddy is free
+void buddyGive(int frame)
+{
+	int k = 0;
+	while (k < hugeCfg.order)
+	{
+		int buddy = frame ^ (1 << k);
+		if (buddy + (1 << k) > frameNum || buddyOrder[buddy] != k)
+			break;
+		buddyUnlink(buddy);
+		if (buddy < frame)
+			frame = buddy;
+		k++;
+	}
+	buddyPush(frame, k);
+}
+
+// Function to take the free frame frame out of the free run holding it, returning the rest of the run to the lists
+// as smaller runs. Returns false if frame is not free.
+bool buddyClaim(int frame)
+{
+	int k = 0;
+	int run = frame;
+	while (k <= hugeCfg.order && buddyOrder[run] != k)
+	{
+		k++;
+		run = frame & ~((1 << k) - 1);
+	}
+	if (k > hugeCfg.order)
+		return false;
+	buddyUnlink(run);
+	// Split run in halves, keeping the half holding frame until it is the frame alone
+	while (k > 0)
+	{
+		k--;
+		int half = run + (1 << k);
+		if (frame >= half)
+		{
+			buddyPush(run, k);
+			run = half;
+		}
+		else
+			buddyPush(half, k);
+	}
+	return true;
+}
+
+// Function to find index of region holding page of process in slot, -1 if page is past the last whole region
+static inline int regionOf(int slot, unsigned page)
+{
+	int region = page >> hugeCfg.order;
+	if (region >= hugeRegions)
+		return -1;
+	return slot * hugeRegions + region;
+}
+
+// Function to get first frame of the large page mapping page of process in slot, -1 if it is mapped by a base page
+int hugeFrame(int slot, unsigned page)
+{
+	int region = regionOf(slot, page);
+	return region == -1 ? -1 : regionRun[region];
+}
+
+// Function to check if frame is part of a mapped large page
+bool hugeIsLarge(int frame)
+{
+	return hugeLargeBits != NULL && bitTest(hugeLargeBits, frame);
+}
+
+// Function to count a reference to page of process in slot mapped by a base page, returns true when its region has
+// been referenced often enough to be worth promoting, starting the count over
+bool hugeTouch(int slot, unsigned page)
+{
+	int region = regionOf(slot, page);
+	if (region == -1 || ++regionRefs[region] < hugeCfg.hotRefs)
+		return false;
+	regionRefs[region] = 0;
+	return true;
+}
+
+// Function to check if a fault on page of process in slot should load its whole region as a large page, as the region
+// was promoted before and is not mapped as a large page now
+bool hugeWanted(int slot, unsigned page)
+{
+	int region = regionOf(slot, page);
+	return region != -1 && regionRun[region] == -1 && bitTest(regionPromoted, region);
+}
+
+// Function to record that region holding page of process in slot is mapped as a large page held by run
+void hugeMap(int slot, unsigned page, int run)
+{
+	int region = regionOf(slot, page);
+	regionRun[region] = run;
+	regionRefs[region] = 0;
+	bitAssign(regionPromoted, region, true);
+	for (int i = 0; i < hugePages(); i++)
+	{
+		bitAssign(hugeLargeBits, run + i, true);
+	}
+	if (++hugeMapped > hugePeakMapped)
+		hugePeakMapped = hugeMapped;
+}
+
+// Function to record that the large page mapping region holding page of process in slot now maps base pages, or
+// nothing once its frames are freed
+void hugeUnmap(int slot, unsigned page)
+{
+	int region = regionOf(slot, page);
+	int run = regionRun[region];
+	for (int i = 0; i < hugePages(); i++)
+	{
+		bitAssign(hugeLargeBits, run + i, false);
+	}
+	regionRun[region] = -1;
+	regionRefs[region] = 0;
+	hugeMapped--;
+}
+
+// Function to forget every large page of process in slot, once its frames have been freed
+void hugeUnmapAll(int slot)
+{
+	for (int r = 0; r < hugeRegions; r++)
+	{
+		if (regionRun[slot * hugeRegions + r] != -1)
+			hugeUnmap(slot, r << hugeCfg.order);
+	}
+}
+
+// Function to forget which regions terminated process in slot referenced or promoted
+void hugeRelease(int slot)
+{
+	memset(&regionRefs[slot * hugeRegions], 0, hugeRegions * sizeof(int));
+	for (int r = 0; r < hugeRegions; r++)
+	{
+		bitAssign(regionPromoted, slot * hugeRegions + r, false);
+	}
+}
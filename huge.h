@@ -0,0 +1,55 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Large pages made of 2^order base pages, each held by an aligned run of as many frames. Free frames are
+// kept by a buddy allocator, which splits free runs to hand out single frames and merges a freed frame with its buddy
+// whenever both halves of a run are free, so aligned runs can be found again. A region of a process's address space is
+// the aligned group of base pages one large page covers. Once a region has been referenced hotRefs times while mapped
+// by base pages that are all resident, the pager promotes it, copying its pages into a free run, or compacting the run
+// already holding most of them if none is free, and mapping them as one large page that takes one TLB entry and one
+// place in the replacement policy. A large page the policy picks as a victim is demoted back to base pages, so memory
+// pressure reclaims it a base page at a time. A fault on a region that has been promoted before and has no page
+// resident loads the whole region into a free run at once. Specs given with -H have the form order[:hotRefs].
+
+#ifndef HUGE_H
+#define HUGE_H
+
+#define MAX_HUGE_ORDER 10 // Most base pages in a large page, as a power of two
+#define DEF_HUGE_HOT_REFS 64 // Default references to a region before it is promoted
+#define HUGE_COPY_NS 2000 // System time to copy a base page into the run of a large page being promoted
+#define HUGE_TLB_KEY 0x80000000u // Bit set in the page a large page's TLB entry is kept under, along with its region
+
+// Structure for large page settings
+typedef struct
+{
+	int order; // Base pages in each large page as a power of two, 0 if large pages are not used
+	int hotRefs; // References to a region mapped by base pages before it is promoted
+} hugeConfig_t;
+
+extern long long hugePromotions; // Regions promoted to large pages
+extern long long hugeDemotions; // Large pages demoted to base pages after being picked as a victim
+extern long long hugeFaults; // Faults that loaded a whole region as a large page
+extern long long hugeCopies; // Base pages copied by promotions
+extern long long hugeNoRun; // Promotions given up as every run holding the region held a large page, and large page
+                             // faults given up as no free run was left
+extern int hugeMapped; // Large pages currently mapped
+extern int hugePeakMapped; // Most large pages mapped at once
+
+bool hugeParse(const char* spec, hugeConfig_t* cfg);
+void hugeInit(const hugeConfig_t* cfg);
+bool hugeEnabled();
+int hugeOrder();
+int hugePages();
+int buddyTake(int order);
+void buddyGive(int frame);
+bool buddyClaim(int frame);
+int hugeFrame(int slot, unsigned page);
+bool hugeIsLarge(int frame);
+bool hugeTouch(int slot, unsigned page);
+bool hugeWanted(int slot, unsigned page);
+void hugeMap(int slot, unsigned page, int run);
+void hugeUnmap(int slot, unsigned page);
+void hugeUnmapAll(int slot);
+void hugeRelease(int slot);
+
+#endif
@@ -0,0 +1,374 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Load control. Each PCB slot keeps a ring of its last window references, along with the reference each
+// of its pages was last used by, so a reference only has to look at the page it adds and the one that drops out of
+// the window to keep the working set size and fault count of the window current. Sums over the active processes are
+// kept the same way, so checking whether memory is overcommitted costs no scan. Shared pages are counted once in the
+// sum, by keeping how many active processes have each of them in their windows.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "load.h"
+#include "pager.h"
+#include "share.h"
+
+long long loadDeferred = 0;
+long long loadDeferNs = 0;
+long long loadSuspensions = 0;
+long long loadResumes = 0;
+long long loadSuspendedNs = 0;
+long long loadFreed = 0;
+int loadPeakDemand = 0;
+
+static loadConfig_t loadCfg = { LOAD_OFF, 0, 0 }; // Settings in use
+static arena_t loadArena = { NULL, 0 }; // Arena the windows and per-slot state are allocated from
+static unsigned* loadRing = NULL; // Last window references of each slot, as page times two plus one if it faulted
+static unsigned* loadLastUse = NULL; // One more than the reference each page of each slot was last used by, 0 if never
+static unsigned* loadRefs = NULL; // References made by process in each slot
+static int* loadWs = NULL; // Working set size of process in each slot
+static int* loadFaults = NULL; // Faults in window of process in each slot
+static bool* loadRunning = NULL; // True if process in slot has started and not exited
+static bool* loadOff = NULL; // True if process in slot is suspended
+static long long* loadOffNs = NULL; // System time process in slot was suspended
+static unsigned long long* loadSeq = NULL; // Order processes started in, to find the newest and oldest
+static unsigned long long loadNextSeq = 0; // Order of next process to start
+static int loadActiveCount = 0; // Processes running and not suspended
+static long long loadActiveWs = 0; // Sum of working sets of active processes
+static long long loadActiveRefs = 0; // Sum of references in windows of active processes
+static long long loadActiveFaults = 0; // Sum of faults in windows of active processes
+static int* loadShareUsers = NULL; // Active processes with each shared page in their windows
+static bool loadHolding = false; // True while a spawn is being held back
+static long long loadHoldNs = 0; // System time current spawn was first held back
+
+// Function to parse load control spec into cfg, returns false if spec is not valid
+bool loadParse(const char* spec, loadConfig_t* cfg)
+{
+	char* end;
+	cfg->window = DEF_LOAD_WINDOW;
+	cfg->highPct = DEF_LOAD_PFF_PCT;
+	const char* p;
+	if (strncmp(spec, "ws", 2) == 0)
+	{
+		cfg->mode = LOAD_WS;
+		p = spec + 2;
+	}
+	else if (strncmp(spec, "pff", 3) == 0)
+	{
+		cfg->mode = LOAD_PFF;
+		p = spec + 3;
+	}
+	else
+		return false;
+	if (*p == '\0')
+		return true;
+
+	if (*p != ':' || p[1] < '0' || p[1] > '9')
+		return false;
+	long window = strtol(p + 1, &end, 10);
+	if (window < 1 || window > MAX_LOAD_WINDOW)
+		return false;
+	cfg->window = window;
+	if (*end == '\0')
+		return true;
+
+	// Only fault frequency has a threshold
+	if (cfg->mode != LOAD_PFF || *end != ':' || end[1] < '0' || end[1] > '9')
+		return false;
+	long pct = strtol(end + 1, &end, 10);
+	cfg->highPct = pct;
+	return *end == '\0' && pct >= 1 && pct <= 100;
+}
+
+// Function to get name of load control model
+const char* loadName(int mode)
+{
+	if (mode == LOAD_WS)
+		return "ws";
+	if (mode == LOAD_PFF)
+		return "pff";
+	return "off";
+}
+
+// Function to start load control with settings in cfg. Called after pagerInit, before any process has started.
+void loadInit(const loadConfig_t* cfg)
+{
+	loadCfg = *cfg;
+	arenaRelease(&loadArena);
+	loadDeferred = 0;
+	loadDeferNs = 0;
+	loadSuspensions = 0;
+	loadResumes = 0;
+	loadSuspendedNs = 0;
+	loadFreed = 0;
+	loadPeakDemand = 0;
+	loadNextSeq = 0;
+	loadActiveCount = 0;
+	loadActiveWs = 0;
+	loadActiveRefs = 0;
+	loadActiveFaults = 0;
+	loadHolding = false;
+	if (loadCfg.mode == LOAD_OFF)
+		return;
+
+	loadRing = arenaArray<unsigned>(&loadArena, (size_t)maxProc * loadCfg.window);
+	loadLastUse = arenaArray<unsigned>(&loadArena, (size_t)maxProc * pageCount);
+	loadRefs = arenaArray<unsigned>(&loadArena, maxProc);
+	loadWs = arenaArray<int>(&loadArena, maxProc);
+	loadFaults = arenaArray<int>(&loadArena, maxProc);
+	loadRunning = arenaArray<bool>(&loadArena, maxProc);
+	loadOff = arenaArray<bool>(&loadArena, maxProc);
+	loadOffNs = arenaArray<long long>(&loadArena, maxProc);
+	loadSeq = arenaArray<unsigned long long>(&loadArena, maxProc);
+	loadShareUsers = arenaArray<int>(&loadArena, sharedPages > 0 ? sharedPages : 1);
+}
+
+// Function to check if load control is on
+bool loadEnabled()
+{
+	return loadCfg.mode != LOAD_OFF;
+}
+
+// Function to get amount of references in window of process in slot
+static inline long long windowRefs(int slot)
+{
+	return loadRefs[slot] < (unsigned)loadCfg.window ? loadRefs[slot] : loadCfg.window;
+}
+
+// Function to count page joining the working set of an active process in the sum over active processes
+static inline void activeJoin(unsigned page)
+{
+	if (page < (unsigned)sharedPages && loadShareUsers[page]++ > 0)
+		return;
+	loadActiveWs++;
+}
+
+// Function to count page leaving the working set of an active process in the sum over active processes
+static inline void activeLeave(unsigned page)
+{
+	if (page < (unsigned)sharedPages && --loadShareUsers[page] > 0)
+		return;
+	loadActiveWs--;
+}
+
+// Function to add or remove process in slot from the sums over active processes
+static void countActive(int slot, int sign)
+{
+	loadActiveCount += sign;
+	loadActiveRefs += sign * windowRefs(slot);
+	loadActiveFaults += sign * loadFaults[slot];
+
+	// Private pages count for themselves, shared pages in the window only for the first active process using them
+	unsigned* last = &loadLastUse[(size_t)slot * pageCount];
+	unsigned n = loadRefs[slot];
+	int shared = 0;
+	for (int page = 0; page < sharedPages; page++)
+	{
+		if (last[page] == 0 || (n > (unsigned)loadCfg.window && last[page] < n - loadCfg.window + 1))
+			continue;
+		shared++;
+		if (sign > 0)
+			activeJoin(page);
+		else
+			activeLeave(page);
+	}
+	loadActiveWs += sign * (loadWs[slot] - shared);
+}
+
+// Function to empty window of process in slot, forgetting every page's last use since pages that left the window long
+// ago would otherwise look like they are in the new one
+static void clearWindow(int slot)
+{
+	memset(&loadLastUse[(size_t)slot * pageCount], 0, pageCount * sizeof(unsigned));
+	loadRefs[slot] = 0;
+	loadWs[slot] = 0;
+	loadFaults[slot] = 0;
+}
+
+// Function to start tracking new process in slot, which starts out active with an empty window
+void loadStart(int slot)
+{
+	if (loadCfg.mode == LOAD_OFF)
+		return;
+	clearWindow(slot);
+	loadRunning[slot] = true;
+	loadOff[slot] = false;
+	loadSeq[slot] = loadNextSeq++;
+	countActive(slot, 1);
+}
+
+// Function to add reference to page by process in slot to its window, dropping the reference that leaves it
+void loadRef(int slot, unsigned page, bool fault)
+{
+	if (loadCfg.mode == LOAD_OFF)
+		return;
+	unsigned* ring = &loadRing[(size_t)slot * loadCfg.window];
+	unsigned* last = &loadLastUse[(size_t)slot * pageCount];
+	unsigned n = loadRefs[slot];
+	unsigned window = loadCfg.window;
+	unsigned at = n % window;
+	int wsChange = 0, faultChange = fault ? 1 : 0;
+	int left = -1;
+
+	if (n >= window)
+	{
+		// Reference n - window leaves, taking its page out of the working set if it was the page's last use
+		unsigned old = ring[at];
+		if (last[old >> 1] == n - window + 1)
+		{
+			wsChange--;
+			left = old >> 1;
+		}
+		faultChange -= old & 1;
+	}
+	else if (!loadOff[slot])
+		loadActiveRefs++;
+
+	// Window now holds references n - window + 1 to n - 1, and page joins the working set unless it was last used by
+	// one of them
+	bool inWindow = last[page] != 0 && (n < window || last[page] >= n - window + 2);
+	if (!inWindow)
+		wsChange++;
+	last[page] = n + 1;
+	ring[at] = page << 1 | (fault ? 1 : 0);
+	loadRefs[slot] = n + 1;
+	loadWs[slot] += wsChange;
+	loadFaults[slot] += faultChange;
+	if (!loadOff[slot])
+	{
+		if (left != -1)
+			activeLeave(left);
+		if (!inWindow)
+			activeJoin(page);
+		loadActiveFaults += faultChange;
+		if (loadActiveWs > loadPeakDemand)
+			loadPeakDemand = loadActiveWs;
+	}
+}
+
+// Function to stop tracking process in slot once it exits
+void loadExit(int slot, long long nowNs)
+{
+	if (loadCfg.mode == LOAD_OFF || !loadRunning[slot])
+		return;
+	if (loadOff[slot])
+		loadSuspendedNs += nowNs - loadOffNs[slot];
+	else
+		countActive(slot, -1);
+	loadRunning[slot] = false;
+	loadOff[slot] = false;
+}
+
+// Function to check if memory is overcommitted by the active processes
+static bool overcommitted()
+{
+	if (loadCfg.mode == LOAD_WS)
+		return loadActiveWs > frameNum;
+	return freeTop == 0 && loadActiveFaults * 100 > loadActiveRefs * loadCfg.highPct;
+}
+
+// Function to check if a process needing ws frames would fit along with the active processes
+static bool fits(long long ws)
+{
+	if (loadActiveCount == 0)
+		return true;
+	if (loadCfg.mode == LOAD_WS)
+		return (loadActiveWs + ws) * 100 <= (long long)frameNum * LOAD_FIT_PCT;
+	return freeTop > 0 || loadActiveFaults * 200 <= loadActiveRefs * loadCfg.highPct;
+}
+
+// Function to check if a new process may be spawned now, expecting it to need as many frames as the average active
+// process. Counts how long the spawn is held back, so it must only be called once a spawn is otherwise due.
+bool loadAdmit(long long nowNs)
+{
+	if (loadCfg.mode == LOAD_OFF)
+		return true;
+	bool admit = fits(loadActiveCount > 0 ? loadActiveWs / loadActiveCount : 0);
+	if (!admit && !loadHolding)
+	{
+		loadHolding = true;
+		loadHoldNs = nowNs;
+		loadDeferred++;
+	}
+	else if (admit && loadHolding)
+	{
+		loadHolding = false;
+		loadDeferNs += nowNs - loadHoldNs;
+	}
+	return admit;
+}
+
+// Function to pick the newest active process to suspend while memory is overcommitted, returns -1 if memory is not
+// overcommitted or only one process is active
+int loadPickSuspend()
+{
+	if (loadCfg.mode == LOAD_OFF || loadActiveCount < 2 || !overcommitted())
+		return -1;
+	int newest = -1;
+	for (int i = 0; i < maxProc; i++)
+	{
+		if (loadRunning[i] && !loadOff[i] && (newest == -1 || loadSeq[i] > loadSeq[newest]))
+			newest = i;
+	}
+	return newest;
+}
+
+// Function to pick the oldest suspended process if it has been suspended long enough and fits along with the active
+// processes, returns -1 if there is none
+int loadPickResume(long long nowNs)
+{
+	if (loadCfg.mode == LOAD_OFF || loadSuspensions == loadResumes)
+		return -1;
+	int oldest = -1;
+	for (int i = 0; i < maxProc; i++)
+	{
+		if (loadRunning[i] && loadOff[i] && (oldest == -1 || loadSeq[i] < loadSeq[oldest]))
+			oldest = i;
+	}
+	if (oldest == -1)
+		return -1;
+	// Always resume once nothing else is active, so the run cannot stall
+	if (loadActiveCount > 0 && (nowNs - loadOffNs[oldest] < LOAD_HOLD_NS || !fits(loadWs[oldest])))
+		return -1;
+	return oldest;
+}
+
+// Function to mark process in slot as suspended, no longer counting it as active
+void loadSuspend(int slot, long long nowNs)
+{
+	countActive(slot, -1);
+	loadOff[slot] = true;
+	loadOffNs[slot] = nowNs;
+	loadSuspensions++;
+}
+
+// Function to mark suspended process in slot as active again. With fault frequency its window starts over, since the
+// faults that got it suspended say nothing about how it runs with the frames it has now.
+void loadResume(int slot, long long nowNs)
+{
+	if (loadCfg.mode == LOAD_PFF)
+		clearWindow(slot);
+	loadOff[slot] = false;
+	loadSuspendedNs += nowNs - loadOffNs[slot];
+	loadResumes++;
+	countActive(slot, 1);
+}
+
+// Function to check if process in slot is suspended
+bool loadSuspended(int slot)
+{
+	return loadCfg.mode != LOAD_OFF && loadOff[slot];
+}
+
+// Function to get amount of frames the working sets of the active processes add up to
+int loadDemand()
+{
+	return (int)loadActiveWs;
+}
+
+// Function to get amount of active processes
+int loadActive()
+{
+	return loadActiveCount;
+}
@@ -0,0 +1,59 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Load control, keeping the processes that run from needing more frames than the frame table holds. Each
+// process's working set is the amount of distinct pages in its last window references, and its fault frequency the
+// amount of those references that faulted. With the working set model, memory is overcommitted once the working sets
+// of the active processes add up to more than the frame table. With the fault frequency model, it is overcommitted
+// once no frame is free and more than highPct of the active processes' recent references fault. Spawns are held back
+// while another process would not fit, the newest active process is suspended while memory is overcommitted, and the
+// oldest suspended process is resumed once it fits again. Specs given with -L have the form ws[:window] or
+// pff[:window[:highPct]].
+
+#ifndef LOAD_H
+#define LOAD_H
+
+// Load control models
+#define LOAD_OFF 0 // Every process is admitted and runs
+#define LOAD_WS 1 // Working set size
+#define LOAD_PFF 2 // Page fault frequency
+
+#define DEF_LOAD_WINDOW 1000 // Default references in each process's window
+#define MAX_LOAD_WINDOW 1000000 // Most references in each process's window
+#define DEF_LOAD_PFF_PCT 10 // Default percent of references faulting while memory is full that overcommits it
+#define LOAD_FIT_PCT 90 // Percent of frames a process must fit in, along with the active processes, to be admitted or resumed
+#define LOAD_HOLD_NS 100000000 // Least system time a process stays suspended
+
+// Structure for load control settings
+typedef struct
+{
+	int mode; // One of the LOAD_ values
+	int window; // References in each process's window
+	int highPct; // Percent of faulting references that overcommits full memory, for LOAD_PFF
+} loadConfig_t;
+
+extern long long loadDeferred; // Spawns held back at least once
+extern long long loadDeferNs; // System time spawns were held back
+extern long long loadSuspensions; // Processes suspended
+extern long long loadResumes; // Processes resumed
+extern long long loadSuspendedNs; // System time processes spent suspended
+extern long long loadFreed; // Frames freed by suspending processes
+extern int loadPeakDemand; // Most frames the working sets of the active processes added up to
+
+bool loadParse(const char* spec, loadConfig_t* cfg);
+const char* loadName(int mode);
+void loadInit(const loadConfig_t* cfg);
+bool loadEnabled();
+void loadStart(int slot);
+void loadRef(int slot, unsigned page, bool fault);
+void loadExit(int slot, long long nowNs);
+bool loadAdmit(long long nowNs);
+int loadPickSuspend();
+int loadPickResume(long long nowNs);
+void loadSuspend(int slot, long long nowNs);
+void loadResume(int slot, long long nowNs);
+bool loadSuspended(int slot);
+int loadDemand();
+int loadActive();
+
+#endif
@@ -0,0 +1,207 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Buffered logging used by oss. Only the main thread of oss logs, so the ring buffer has a single producer
+// and the writer thread is its single consumer. When the pager is sharded, shard threads log as well, so producers take
+// a lock around their copy into the ring buffer once logShare has been called. The producer only wakes the writer once
+// a batch has built up, so most messages cost a format and a copy, with no system call.
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "log.h"
+
+int logLevel = LOG_REFS; // Highest level of messages that are printed
+
+static char logRing[LOG_RING_SIZE]; // Formatted messages waiting to be written
+static std::atomic<unsigned> logHead(0); // Next byte to be written out, only moved by writer
+static std::atomic<unsigned> logTail(0); // Next byte to be filled, only moved by producer
+static std::atomic<unsigned> logWake(0); // Futex word writer sleeps on
+static std::atomic<int> logSleeping(0); // True while writer is sleeping
+static std::atomic<bool> logStopping(false); // True once writer should drain buffer and exit
+static FILE* logOut = NULL; // Logfile messages are also written to, NULL if none
+static std::thread logWriter; // Background writer thread
+static bool logRunning = false; // True while writer thread exists
+static pid_t logPid = -1; // Process writer thread belongs to, forked children must not touch it
+static bool logShared = false; // True once more than one thread may log
+static std::mutex logPushLock; // Taken by producers around copy into ring buffer while logShared is true
+
+// Function to wake writer if it is sleeping
+static void logNotify()
+{
+	// Order filled bytes before check of sleeping flag, pairing with fence in writer
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (logSleeping.load())
+	{
+		logWake.fetch_add(1);
+		syscall(SYS_futex, (unsigned*)&logWake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+}
+
+// Function run by writer thread, copying buffered bytes out in the largest blocks available until stopped
+static void logWriterMain()
+{
+	struct timespec wait = { 0, LOG_WAIT_NS };
+	unsigned head = logHead.load(std::memory_order_relaxed);
+	while (true)
+	{
+		unsigned tail = logTail.load(std::memory_order_acquire);
+		if (head == tail)
+		{
+			// Buffer is empty, make output visible and exit if stopping
+			fflush(stdout);
+			if (logOut != NULL)
+				fflush(logOut);
+			if (logStopping.load())
+				return;
+
+			// Sleep until producer fills a batch or wait time passes, rechecking after announcing so a wake is not missed
+			unsigned seen = logWake.load();
+			logSleeping.store(1);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (logTail.load() == head && !logStopping.load())
+				syscall(SYS_futex, (unsigned*)&logWake, FUTEX_WAIT_PRIVATE, seen, &wait, NULL, 0);
+			logSleeping.store(0);
+			continue;
+		}
+
+		// Write up to end of buffer, the rest is written on the next pass
+		unsigned start = head & (LOG_RING_SIZE - 1);
+		unsigned len = tail - head;
+		if (len > LOG_RING_SIZE - start)
+			len = LOG_RING_SIZE - start;
+		fwrite(logRing + start, 1, len, stdout);
+		if (logOut != NULL)
+			fwrite(logRing + start, 1, len, logOut);
+		head += len;
+		logHead.store(head, std::memory_order_release);
+	}
+}
+
+// Function to start writer thread, writing to console and to file if it is not NULL, and set verbosity level
+void logInit(FILE* file, int level)
+{
+	logOut = file;
+	logLevel = level;
+
+	// Block signals in writer so alarm is always handled by the main thread, which shuts the writer down
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	logWriter = std::thread(logWriterMain);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	logRunning = true;
+	logPid = getpid();
+
+	// Write out whatever is still buffered when oss exits, including through exit() on errors
+	atexit(logShutdown);
+}
+
+// Function to copy formatted message into ring buffer, waiting for writer whenever the buffer is full
+static void logPush(const char* msg, unsigned len)
+{
+	unsigned tail = logTail.load(std::memory_order_relaxed);
+	while (len > 0)
+	{
+		// Wait for writer to free space
+		unsigned space = LOG_RING_SIZE - (tail - logHead.load(std::memory_order_acquire));
+		if (space == 0)
+		{
+			logWake.fetch_add(1);
+			syscall(SYS_futex, (unsigned*)&logWake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+			sched_yield();
+			continue;
+		}
+
+		// Copy up to end of buffer or as much as fits
+		unsigned start = tail & (LOG_RING_SIZE - 1);
+		unsigned n = len;
+		if (n > space)
+			n = space;
+		if (n > LOG_RING_SIZE - start)
+			n = LOG_RING_SIZE - start;
+		memcpy(logRing + start, msg, n);
+		msg += n;
+		len -= n;
+		tail += n;
+		logTail.store(tail, std::memory_order_release);
+	}
+
+	// Wake writer once a batch is waiting
+	if (tail - logHead.load(std::memory_order_relaxed) >= LOG_BATCH)
+		logNotify();
+}
+
+// Function to format message and queue it for writing if its level is printed
+void logPrintf(int level, const char* fmt, ...)
+{
+	if (!logEnabled(level))
+		return;
+
+	// Format into line, or into a buffer large enough if message did not fit
+	char line[LOG_LINE];
+	char* msg = line;
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(line, sizeof(line), fmt, args);
+	va_end(args);
+	if (len < 0)
+		return;
+	if (len >= LOG_LINE)
+	{
+		msg = (char*)malloc(len + 1);
+		if (msg == NULL)
+		{
+			perror("malloc log message");
+			exit(1);
+		}
+		va_start(args, fmt);
+		vsnprintf(msg, len + 1, fmt, args);
+		va_end(args);
+	}
+
+	// Queue for writer, or print straight to console and logfile if writer is not running
+	if (logRunning && logShared)
+	{
+		std::lock_guard<std::mutex> guard(logPushLock);
+		logPush(msg, len);
+	}
+	else if (logRunning)
+		logPush(msg, len);
+	else
+	{
+		fputs(msg, stdout);
+		if (logOut != NULL)
+			fputs(msg, logOut);
+	}
+	if (msg != line)
+		free(msg);
+}
+
+// Function to let other threads besides the main thread log, called before they are started
+void logShare()
+{
+	logShared = true;
+}
+
+// Function to write out everything buffered and stop writer thread
+void logShutdown()
+{
+	if (!logRunning || getpid() != logPid)
+		return;
+	logRunning = false;
+	logStopping.store(true);
+	logWake.fetch_add(1);
+	syscall(SYS_futex, (unsigned*)&logWake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	logWriter.join();
+}
@@ -0,0 +1,36 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Buffered logging used by oss. Each message is formatted once into a lock-free ring buffer, and a
+// background writer thread copies the buffer to the console, and to the logfile if one is open, in large blocks.
+// Messages above the selected verbosity level are dropped before they are formatted.
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+
+// Verbosity levels, each level also prints everything below it
+#define LOG_STATS 0 // Final statistics and run notices only
+#define LOG_TABLES 1 // Process, frame and page tables every 1 sec of system time
+#define LOG_REFS 2 // Every request, hit, fault and swap
+
+#define LOG_RING_SIZE (1 << 20) // Bytes the ring buffer can hold, must be a power of two
+#define LOG_BATCH (1 << 16) // Bytes buffered before the writer is woken, it also wakes on its own every LOG_WAIT_NS
+#define LOG_WAIT_NS 10000000 // Longest time writer sleeps before checking the buffer
+#define LOG_LINE 1024 // Size of buffer most messages are formatted in
+
+extern int logLevel; // Highest level of messages that are printed
+
+void logInit(FILE* file, int level);
+void logPrintf(int level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+void logShare();
+void logShutdown();
+
+// Function to check if messages of a level are printed, so callers can skip work spent only building them
+static inline bool logEnabled(int level)
+{
+	return level <= logLevel;
+}
+
+#endif
@@ -0,0 +1,215 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: NUMA node model. Free frames of every node share one array, each node's stack using the part of it at
+// the start of its own range of frames, so a node never needs more room than it has frames. First-touch placement keeps
+// the node each page of each PCB slot was first loaded on, which is forgotten when the process terminates.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "numa.h"
+#include "pager.h"
+
+long long numaLocalRefs = 0;
+long long numaRemoteRefs = 0;
+long long numaLocalLoads = 0;
+long long numaRemoteLoads = 0;
+long long numaMigrations = 0;
+
+static numaConfig_t numaCfg = { 0, NUMA_LOCAL, 0 }; // Settings in use
+static arena_t numaArena = { NULL, 0 }; // Arena the free stacks and per-frame counts are allocated from
+static int* numaStack = NULL; // Free frames of every node, node n's stack starting at the first frame of its range
+static int* numaTop = NULL; // Amount of free frames on each node's stack
+static int* numaRemoteHits = NULL; // References to each frame from another node since its page was loaded
+static unsigned char* numaTouched = NULL; // Node plus one each page of each slot was first loaded on, 0 if never
+
+// Function to find first frame of node's range of frames
+static inline int nodeStart(int node)
+{
+	return (int)(((long long)node * frameNum + numaCfg.nodes - 1) / numaCfg.nodes);
+}
+
+// Function to parse NUMA spec into cfg, returns false if spec is not valid
+bool numaParse(const char* spec, numaConfig_t* cfg)
+{
+	char* end;
+	if (*spec < '0' || *spec > '9')
+		return false;
+	long nodes = strtol(spec, &end, 10);
+	if (nodes < 1 || nodes > MAX_NUMA_NODES)
+		return false;
+	cfg->nodes = nodes;
+	cfg->placement = NUMA_LOCAL;
+	cfg->migrateRefs = 0;
+	if (*end == '\0')
+		return true;
+	if (*end != ':')
+		return false;
+
+	// Split placement from migration threshold
+	const char* name = end + 1;
+	const char* colon = strchr(name, ':');
+	size_t nameLen = colon ? (size_t)(colon - name) : strlen(name);
+	if (nameLen == 5 && strncmp(name, "local", nameLen) == 0)
+		cfg->placement = NUMA_LOCAL;
+	else if (nameLen == 10 && strncmp(name, "interleave", nameLen) == 0)
+		cfg->placement = NUMA_INTERLEAVE;
+	else if (nameLen == 10 && strncmp(name, "firsttouch", nameLen) == 0)
+		cfg->placement = NUMA_FIRSTTOUCH;
+	else
+		return false;
+	if (colon == NULL)
+		return true;
+
+	if (colon[1] < '0' || colon[1] > '9')
+		return false;
+	long refs = strtol(colon + 1, &end, 10);
+	cfg->migrateRefs = refs;
+	return *end == '\0' && refs <= 1000000;
+}
+
+// Function to get name of placement policy
+const char* numaName(int placement)
+{
+	if (placement == NUMA_INTERLEAVE)
+		return "interleave";
+	if (placement == NUMA_FIRSTTOUCH)
+		return "firsttouch";
+	return "local";
+}
+
+// Function to split frame table into nodes with settings in cfg. Called right after pagerInit, while every frame is
+// free, and takes every frame onto the stack of its node.
+void numaInit(const numaConfig_t* cfg)
+{
+	numaCfg = *cfg;
+	arenaRelease(&numaArena);
+	numaLocalRefs = 0;
+	numaRemoteRefs = 0;
+	numaLocalLoads = 0;
+	numaRemoteLoads = 0;
+	numaMigrations = 0;
+	numaTouched = NULL;
+	if (numaCfg.nodes == 0)
+		return;
+
+	numaStack = arenaArray<int>(&numaArena, frameNum);
+	numaTop = arenaArray<int>(&numaArena, numaCfg.nodes);
+	numaRemoteHits = arenaArray<int>(&numaArena, frameNum);
+	if (numaCfg.placement == NUMA_FIRSTTOUCH)
+		numaTouched = arenaArray<unsigned char>(&numaArena, (size_t)maxProc * pageCount);
+
+	// Push frames of each node highest first, so the lowest frame of each node is used first
+	for (int n = 0; n < numaCfg.nodes; n++)
+	{
+		int start = nodeStart(n);
+		for (int i = nodeStart(n + 1) - 1; i >= start; i--)
+		{
+			numaStack[start + numaTop[n]++] = i;
+		}
+	}
+}
+
+// Function to check if memory is split into nodes
+bool numaEnabled()
+{
+	return numaCfg.nodes > 0;
+}
+
+// Function to get amount of nodes
+int numaNodes()
+{
+	return numaCfg.nodes;
+}
+
+// Function to find node frame belongs to
+int numaFrameNode(int frame)
+{
+	return (int)((long long)frame * numaCfg.nodes / frameNum);
+}
+
+// Function to find node process in slot runs on at the current time
+int numaCpuNode(int slot)
+{
+	return (int)((slot + clockNow() / NUMA_MOVE_NS) % numaCfg.nodes);
+}
+
+// Function to take a free frame of node, returns -1 if node has none
+int numaTakeNode(int node)
+{
+	if (numaTop[node] == 0)
+		return -1;
+	int frame = numaStack[nodeStart(node) + --numaTop[node]];
+	numaRemoteHits[frame] = 0;
+	return frame;
+}
+
+// Function to take a free frame for page of process in slot, from the node the placement policy picks, or the next
+// node after it with a free frame once it is full. Returns -1 only if no node has a free frame.
+int numaTake(int slot, unsigned page)
+{
+	int cpu = numaCpuNode(slot);
+	int want = cpu;
+	unsigned char* touched = NULL;
+	if (numaCfg.placement == NUMA_INTERLEAVE)
+		want = page % numaCfg.nodes;
+	else if (numaCfg.placement == NUMA_FIRSTTOUCH)
+	{
+		touched = &numaTouched[(size_t)slot * pageCount + page];
+		if (*touched != 0)
+			want = *touched - 1;
+	}
+
+	for (int i = 0; i < numaCfg.nodes; i++)
+	{
+		int node = (want + i) % numaCfg.nodes;
+		int frame = numaTakeNode(node);
+		if (frame == -1)
+			continue;
+		if (node == cpu)
+			numaLocalLoads++;
+		else
+			numaRemoteLoads++;
+		// First load decides where the page lives from then on
+		if (touched != NULL && *touched == 0)
+			*touched = node + 1;
+		return frame;
+	}
+	return -1;
+}
+
+// Function to return free frame to the stack of its node
+void numaGive(int frame)
+{
+	int node = numaFrameNode(frame);
+	numaStack[nodeStart(node) + numaTop[node]++] = frame;
+}
+
+// Function to count reference by process in slot to frame, adding the extra time of a remote reference to the clock.
+// Returns true if the page has now been referenced remotely often enough to be migrated.
+bool numaAccess(int slot, int frame)
+{
+	if (numaFrameNode(frame) == numaCpuNode(slot))
+	{
+		numaLocalRefs++;
+		return false;
+	}
+	numaRemoteRefs++;
+	clockAdd(NUMA_REMOTE_NS);
+	numaRemoteHits[frame]++;
+	return numaCfg.migrateRefs > 0 && numaRemoteHits[frame] >= numaCfg.migrateRefs;
+}
+
+// Function to forget where pages of terminated process in slot were first loaded
+void numaRelease(int slot)
+{
+	if (numaTouched != NULL && numaCfg.placement == NUMA_FIRSTTOUCH)
+		memset(&numaTouched[(size_t)slot * pageCount], 0, pageCount);
+}
+
+// Function to get amount of free frames on node
+int numaFree(int node)
+{
+	return numaTop[node];
+}
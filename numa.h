@@ -0,0 +1,52 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Model of memory split into NUMA nodes. The frame table is divided into equal ranges of frames, one per
+// node, each with its own stack of free frames. Every process runs on one node at a time, starting on the node of its
+// PCB slot and moved to the next node by the scheduler every NUMA_MOVE_NS of system time, and a reference to a frame on
+// another node costs NUMA_REMOTE_NS more than one to a frame on its own node. The placement policy picks the node a
+// faulted page is loaded on, and a page referenced remotely often enough can be migrated to the node its process runs
+// on. Specs given with -N have the form nodes[:placement[:migrateRefs]], for example 4:interleave:8.
+
+#ifndef NUMA_H
+#define NUMA_H
+
+// Placement policies
+#define NUMA_LOCAL 0 // Page is loaded on the node its process runs on
+#define NUMA_INTERLEAVE 1 // Pages of a process are spread across nodes by page number
+#define NUMA_FIRSTTOUCH 2 // Page is loaded on the node it was first loaded on, wherever its process runs now
+
+#define MAX_NUMA_NODES 64 // Most nodes memory can be split into
+#define NUMA_REMOTE_NS 100 // Extra system time of a reference to a frame on another node
+#define NUMA_MIGRATE_NS 2000 // System time to copy a page to a frame on another node
+#define NUMA_MOVE_NS 1000000000 // System time a process runs on a node before it is moved to the next one
+
+// Structure for NUMA settings
+typedef struct
+{
+	int nodes; // Amount of nodes, 0 if memory is not split
+	int placement; // One of the NUMA_ placement values
+	int migrateRefs; // Remote references to a page before it is migrated, 0 to never migrate
+} numaConfig_t;
+
+extern long long numaLocalRefs; // References to frames on the node of the referencing process
+extern long long numaRemoteRefs; // References to frames on another node
+extern long long numaLocalLoads; // Pages loaded on the node of their process
+extern long long numaRemoteLoads; // Pages loaded on another node, by placement or because their process's node was full
+extern long long numaMigrations; // Pages migrated to the node of their process
+
+bool numaParse(const char* spec, numaConfig_t* cfg);
+const char* numaName(int placement);
+void numaInit(const numaConfig_t* cfg);
+bool numaEnabled();
+int numaNodes();
+int numaFrameNode(int frame);
+int numaCpuNode(int slot);
+int numaTake(int slot, unsigned page);
+int numaTakeNode(int node);
+void numaGive(int frame);
+bool numaAccess(int slot, int frame);
+void numaRelease(int slot);
+int numaFree(int node);
+
+#endif
@@ -5,13 +5,17 @@
 // Description: A program that simulates a paging memory management operating system.
 // This program runs until it has forked the total amount of processes specified in the command line, while allowing a
 // specified amount of processes to run simultaneously. It will allocate shared memory to represent a system clock. It will
-// also keep track of a process control block table for all processes, each with a 32 entry page table, and a page frame 
-// table of 256 frames. It will receive messages from child processes that represent a memory request to read or write. If
+// also keep track of a process control block table for all processes, each with a page table of 32 entries, and a page
+// frame table of 256 frames, unless other sizes are given with -g, -z and -m. It will receive messages from child processes that represent a memory request to read or write. If
 // the requested page is in the frame table, it will grant the request and update the PCB and frame table to reflect this. 
 // In the case of a page fault, it will add the worker to a wait queue, and add the required latency. Once this time has passed,
-// it will load the page using the least recently used algorithm and update all tables to reflect this. It will print all tables 
-// every 1 sec of system time. It will calculate and print final statistics at the end of each run.
+// it will load the page, evicting a frame chosen by the selected replacement policy (least recently used by default),
+// and update all tables to reflect this. It will print all tables every 1 sec of system time. It will calculate and print final statistics at the end of each run.
 // The program will send a kill signal to all processes and terminate if 5 real-life seconds are reached.
+// It can also record every reference to a binary trace file and later replay that file through the pager.
+// In discrete event mode, workers report the time of their next request and sleep, and oss moves the clock straight to
+// the earliest pending event instead of stepping it while everyone polls. The in-process engine runs the same
+// reference streams as the worker program inside oss, posting requests to an in-memory queue instead of forking.
 
 #include <sys/ipc.h>
 #include <sys/shm.h>
@@ -25,12 +29,38 @@
 #include <unistd.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/resource.h>
 #include <string>
 #include <queue>
 
+#include <unordered_map>
+#include <vector>
+#include <limits.h>
+#include "pager.h"
+#include "simclock.h"
+#include "transport.h"
+#include "refgen.h"
+#include "log.h"
+#include "trace.h"
+#include "stats.h"
+#include "counters.h"
+#include "tlb.h"
+#include "pagetable.h"
+#include "arena.h"
+#include "swap.h"
+#include "prefetch.h"
+#include "shard.h"
+#include "numa.h"
+#include "snapshot.h"
+#include "load.h"
+#include "share.h"
+#include "huge.h"
+
 #define PERMS 0644
-#define MAX_PROC 18
-#define FRAME_NUM 256
+#define DEF_WATCHDOG 5 // Default real seconds before the watchdog ends the run
+#define EXIT_TRUNCATED 3 // Exit status of a run ended by the watchdog before every process finished
+#define PRINT_FRAMES 256 // Largest frame table printed frame by frame, larger tables print a summary
+#define PRINT_PAGES 32 // Largest page table printed entry by entry, larger tables print only resident pages
 
 using namespace std;
 
@@ -41,94 +71,140 @@ typedef struct
 	int simul;
 	long long interval;
 	string logfile;
+	const char* policy;
+	bool record;
+	bool replay;
+	bool ring;
+	int batch;
+	bool des;
+	bool inproc;
+	int frames;
+	int pages;
+	unsigned pageSize;
+	int verbose;
+	const char* gen;
+	int writePct;
+	bool metrics;
+	int watchdog;
+	const char* tlb;
+	const char* swap;
+	const char* prefetch;
+	int shards;
+	const char* numa;
+	const char* snapshot;
+	const char* load;
+	int shared;
+	const char* huge;
 } options_t;
 
-// Structure for Process Control Block
-typedef struct
-{
-        int occupied; // Either true or false, determines if slot is occupied
-        pid_t pid; // Process ID of this child
-        int startSeconds; // Second time when it was forked
-        int startNano; // Nanosecond time when it was forked
-	int pageTable [32]; // Process's 32 pages for frame
-	bool waiting; // True if process is currently waiting due to page fault
-	int waitPage; // Page number processes is waiting to be loaded
-	bool waitIsWrite; // True if waiting reference is a write
-	long long waitSec; // Second time of page fault
-	long long waitNano; // Nanosecond time of page fault
-} PCB;
-
-// Structure for frame table
-typedef struct
-{
-	bool occupied; // Either true or false, determines if frame is free to use
-	bool dirty; // True if frame has been written
-	pid_t ownerPid; // PID of process that owns page in frame
-	int pageNum; // Page number in frame
-	long long lastRefSec; // Second time of access
-	long long lastRefNano; // Nanosecond time of access
-} Frame;
-
-// Message buffer for communication between OSS and child processes
-typedef struct msgbuffer 
-{
-	long mtype; // Message type used for message queue
-	pid_t pid;
-	unsigned address;
-	bool isWrite;
-	bool granted; // Grant resources to worker
-} msgbuffer;
+// Structure to hold values for options in command line argument
+options_t options;
 
 // Global variables
-PCB* processTable; // Process control block table to track child processes
-Frame* frameTable;
-queue<int> waitQueue;
+// Processes waiting on page faults, ordered by the time their fault latency has passed
+waitQueue_t waitQueue;
 
 int running; // Amount of running processes in system
+int total = 0; // Total number of child processes spawned
+long long totRefs = 0; // Total number of memory reference requests received
+long long totFaults = 0; // Total number of page faults
 
-int *shm_ptr; // Shared memory pointer to store system clock
+simClock_t* simClock; // Shared memory system clock
 int shm_id; // Shared memory ID
 
 int msqid; // Queue ID for communication
 msgbuffer buf; // Message buffer to send messages
 msgbuffer rcvbuf; // Message buffer to receive messages
 
+bool useRing = false; // True if workers post requests to shared memory rings instead of the message queue
+ringHeader_t* ringHeader = NULL; // Header at start of ring segment
+ringSlot_t* ringSeg = NULL; // Shared memory ring slots, one per PCB slot
+int ring_id = -1; // Shared memory ID of ring segment
+int ringCursor = 0; // Slot to check first for the next request, so every worker gets a turn
+int ringSpin = RING_SPIN; // Passes over the rings before oss sleeps, 0 if oss shares a single processor with workers
+
+ossCounters_t* counters = NULL; // Shared memory counters of work done by oss
+int ctr_id = -1; // Shared memory ID of counters segment
+
+// In-process engine, where simulated processes are run by oss as reference streams instead of forked workers
+refConfig_t refConfig; // Reference generator settings, given to every worker
+tlbConfig_t tlbConfig; // TLB settings
+swapConfig_t swapConfig; // Swap device settings
+prefetchConfig_t prefetchConfig; // Prefetch settings
+numaConfig_t numaConfig; // NUMA node settings
+snapConfig_t snapConfig; // Settings for printing only changes
+loadConfig_t loadConfig; // Load control settings
+hugeConfig_t hugeConfig; // Large page settings
+msgbuffer* parkedMsg; // Request each suspended process made after it was suspended, held until it is resumed
+bool* parked; // True if slot has a request in parkedMsg
+int parkedCount = 0; // Amount of parked requests
+refState_t* inprocState; // Reference stream of in-process worker in each PCB slot
+msgbuffer* inprocQueue; // Ring of requests posted by in-process workers, waiting to be received by oss. Each worker
+                        // has at most one request posted, so it holds one per PCB slot.
+int inprocHead = 0; // Index of oldest request in in-process queue
+int inprocCount = 0; // Amount of requests in in-process queue
+pid_t inprocNextPid = 1; // Simulated pid to give next in-process worker
+
+// Grants waiting to be sent at the end of the loop iteration. Each worker has at most one request outstanding,
+// so there can never be more than one grant per PCB slot.
+int* grantSlots; // PCB slot of each queued grant
+pid_t* grantPids; // PID of each queued grant
+
+arena_t runArena = { NULL, 0 }; // Arena tables of oss sized by the process table are allocated from
+int grantCount = 0; // Amount of queued grants
+
+long long startWallNs; // Real time oss started, in ns
+volatile sig_atomic_t truncated = 0; // Set by the watchdog's signal handler once its real time has passed
+
 bool logging = false; // Bool to determine if output should also print to logfile
 FILE* logfile = NULL; // Pointer to logfile
 
 void print_usage(const char * app)
 {
-	fprintf(stdout, "usage: %s [-h] [-n proc] [-s simul] [-i intervalInMsToLaunchChildren] [-f]\n", app);
+	fprintf(stdout, "usage: %s [-h] [-n proc] [-s simul] [-i intervalInMsToLaunchChildren] [-f] [-p policy] [-r] [-R] [-t transport] [-b batch] [-d] [-e engine] [-m frames] [-g pages] [-z pageSize] [-v level] [-w generator] [-W writePct] [-x] [-a seconds] [-T tlb] [-P pageTable] [-D swap] [-F prefetch] [-S shards] [-N numa] [-U snapshot] [-L load] [-C shared] [-H huge]\n", app);
 	fprintf(stdout, "      proc is the number of total children to launch\n");
 	fprintf(stdout, "      simul indicates how many children are to be allowed to run simultaneously\n");
+	fprintf(stdout, "      frames is the size of the frame table (default %d)\n", DEF_FRAMES);
+	fprintf(stdout, "      pages is the amount of pages in each process's address space (default %d)\n", DEF_PAGES);
+	fprintf(stdout, "      pageSize is the size of a page in bytes (default %d)\n", DEF_PAGE_SIZE);
+	fprintf(stdout, "      generator is how workers pick pages, one of uniform, zipf[:s], seq, stride[:pages] or phase[:pages[:refs]] (default %s)\n", DEF_GEN);
+	fprintf(stdout, "      writePct is the percent of references that are writes (default %d)\n", DEF_WRITE_PCT);
 	fprintf(stdout, "      itnterval is the time between launching children\n");
 	fprintf(stdout, "      selecting f will output to a logfile as well\n");
+	fprintf(stdout, "      level is what is printed, %d for final statistics, %d to add tables every second, %d to add every reference (default %d)\n", LOG_STATS, LOG_TABLES, LOG_REFS, LOG_REFS);
+	fprintf(stdout, "      policy is the page replacement policy, one of:");
+	printPolicies(stdout);
+	fprintf(stdout, " (default lru)\n");
+	fprintf(stdout, "      selecting r will record every memory reference to binary trace %s\n", TRACE_FILE);
+	fprintf(stdout, "      transport is how workers send requests, msgq (default) or ring for shared memory rings\n");
+	fprintf(stdout, "      batch is the most worker messages handled per loop iteration (default %d)\n", DEF_PROC);
+	fprintf(stdout, "      selecting d runs as discrete events, moving the clock straight to the next event while workers sleep\n");
+	fprintf(stdout, "      engine is fork (default) to run workers as processes, or inproc to run them inside oss as discrete events\n");
+	fprintf(stdout, "      selecting R will replay %s instead of launching children, required for opt\n", TRACE_FILE);
+	fprintf(stdout, "      tlb is off (default), or global, flush or proc followed by optional :entries[:ways] (default %d entries, %d ways)\n", DEF_TLB_ENTRIES, DEF_TLB_WAYS);
+	fprintf(stdout, "      pageTable is flat (default) for an array per process, radix for a tree allocated as pages are touched, or hash for one inverted table of frames\n");
+	fprintf(stdout, "      swap is latencyUs:bandwidthMBps[:cleanFrames] of a swap device faults are read from, off by default for a fixed %d ms per fault\n", FAULT_READ_NS / 1000000);
+	fprintf(stdout, "      prefetch is off (default), seq or stride followed by optional :depth, the most pages loaded ahead on each fault (default %d)\n", DEF_PREFETCH_DEPTH);
+	fprintf(stdout, "      shards is the amount of threads, up to %d, servicing ring transport requests with lru, each with its own share of the process and frame tables\n", MAX_SHARDS);
+	fprintf(stdout, "      numa is nodes, up to %d, followed by optional :placement[:migrateRefs], placement local (default), interleave or firsttouch\n", MAX_NUMA_NODES);
+	fprintf(stdout, "      snapshot is delta[:fullEvery] to print only what changed in the tables, writing them in full to %s every fullEvery prints (default %d, 0 for never)\n", SNAP_FILE, DEF_SNAP_EVERY);
+	fprintf(stdout, "      load is ws[:window] or pff[:window[:highPct]] to hold back spawns and suspend processes while their working sets or fault rates overcommit memory (default window %d, highPct %d)\n", DEF_LOAD_WINDOW, DEF_LOAD_PFF_PCT);
+	fprintf(stdout, "      shared is the amount of pages at the start of every address space that all processes share, copied on a process's first write\n");
+	fprintf(stdout, "      huge is order[:hotRefs] for large pages of 2^order pages, up to order %d, promoted once a region is referenced hotRefs times with all of its pages resident (default %d)\n", MAX_HUGE_ORDER, DEF_HUGE_HOT_REFS);
+	fprintf(stdout, "      seconds is the real time before the run is ended with exit status %d, 0 for no limit (default %d)\n", EXIT_TRUNCATED, DEF_WATCHDOG);
+	fprintf(stdout, "      selecting x will write latency percentiles to %s every table print and histograms to %s at exit\n", METRICS_CSV, METRICS_JSON);
 }
 
-// Function to increment system clock in seconds and nanoseconds
+// Function to increment system clock by 10 ms
 void incrementClock()
 {
-	// Update nanoseconds and check for overflow
-	shm_ptr[1] += 10000000;
-	if (shm_ptr[1] >= 1000000000) // Determines if nanosec is gt 1 billion, meaning it should convert to 1 second
-	{
-		shm_ptr[1] -= 1000000000;
-		shm_ptr[0]++;
-	}
-
+	clockAdd(10000000);
 }
 
 // Function to add a small overhead of 1000 ns to the clock (less amount than incrmenting clock)
 void addOverhead()
 {
-	// Increment ns in shared memor
-	shm_ptr[1] += 1000;
-	// Check for overflow
-	if (shm_ptr[1] >= 1000000000)
-	{
-		shm_ptr[1] -= 1000000000;
-		shm_ptr[0]++;
-	}
+	clockAdd(1000);
 }
 
 // Function to access and add to shared memory
@@ -137,8 +213,8 @@ void shareMem()
 	// Generate key
 	const int sh_key = ftok("main.c", 0);
 	// Create shared memory
-	shm_id = shmget(sh_key, sizeof(int) * 2, IPC_CREAT | 0666);
-	if (shm_id <= 0) // Check if shared memory get failed
+	shm_id = shmget(sh_key, sizeof(simClock_t), IPC_CREAT | 0666);
+	if (shm_id == -1) // Check if shared memory get failed
 	{
 		// If true, print error message and exit
 		fprintf(stderr, "Shared memory get failed\n");
@@ -146,158 +222,182 @@ void shareMem()
 	}
 	
 	// Attach shared memory
-	shm_ptr = (int*)shmat(shm_id, 0, 0);
-	if (shm_ptr <= 0)
+	simClock = (simClock_t*)shmat(shm_id, 0, 0);
+	if (simClock == (simClock_t*)-1)
 	{
 		fprintf(stderr, "Shared memory attach failed\n");
 		exit(1);
 	}
-	// Initialize shared memory pointers to represent clock
-	// Index 0 represents seconds, index 1 represents nanoseconds
-	shm_ptr[0] = 0;
-	shm_ptr[1] = 0;
+	// Start clock at time 0
+	clockSet(0);
 }
 
-// Function to print formatted process table, each process's page table,  and frame table to console. Will also print to logfile if necessary.
-void printInfo(int n)
+// Function to create shared memory segment holding counters, readable by other programs while oss runs
+void shareCounters()
 {
-
-	printf("\n");
-	if (logging) fprintf(logfile, "\n");
-
-	// Print process control block 	
-	printf("OSS PID: %d SysClockS: %u SysClockNano: %u\n Process Table:\n", getpid(), shm_ptr[0], shm_ptr[1]);
-	printf("Entry\tOccupied\tPID\tStartS\tStartNs\n");
-	
-	if(logging) fprintf(logfile, "OSS PID: %d SysClockS: %u SysClockNano: %u\n Process Table:\n", getpid(), shm_ptr[0], shm_ptr[1]);
-	if (logging) fprintf(logfile,"Entry\tOccupied\tPID\tStartS\tStartNs\n");
-
-	for (int i = 0; i < n; i++)
+	// Generate key from same file as message queue
+	key_t ctr_key = ftok("msgq.txt", CTR_PROJ);
+	if (ctr_key == -1)
 	{
-		// Print table only if occupied by process
-		if (processTable[i].occupied == 1)
-		{
-			printf("%d\t%d\t\t%d\t%u\t%u\n", i, processTable[i].occupied, processTable[i].pid, processTable[i].startSeconds, processTable[i].startNano);
-			if (logging) fprintf(logfile, "%d\t%d\t\t%d\t%u\t%u\n", i, processTable[i].occupied, processTable[i].pid, processTable[i].startSeconds, processTable[i].startNano);
-		}
+		perror("ftok counters");
+		exit(1);
 	}
-	printf("\n");
-	if (logging) fprintf(logfile, "\n");
-
-	// Print frame table
-	printf("Current memory layout at time %u:%09u is:\n", shm_ptr[0], shm_ptr[1]);
-	if (logging) fprintf(logfile, "Current memory layout at time %u:%09u is:\n", shm_ptr[0], shm_ptr[1]);
-
-	printf("      %-8s %-8s %-8s %-12s\n", "Occupied", "DirtyBit", "LastRefS", "LastRefNano");
-	if (logging) fprintf(logfile, "      %-8s %-8s %-8s %-12s\n", "Occupied", "DirtyBit", "LastRefS", "LastRefNano");
-
-	for (int i = 0; i < FRAME_NUM; i++)
+	// Create shared memory
+	ctr_id = shmget(ctr_key, sizeof(ossCounters_t), IPC_CREAT | 0666);
+	if (ctr_id == -1)
 	{
-		string occ = "No";
-		if (frameTable[i].occupied)
-			occ = "Yes";
-		printf("Frame %d: %-8s %-8d %-8lld %-12lld\n", i, occ.c_str(), frameTable[i].dirty, frameTable[i].lastRefSec, frameTable[i].lastRefNano);
-		if (logging)
-			fprintf(logfile, "Frame %d: %-8s %-8d %-8lld %-12lld\n", i, occ.c_str(), frameTable[i].dirty, frameTable[i].lastRefSec, frameTable[i].lastRefNano);
+		fprintf(stderr, "Counters shared memory get failed\n");
+		exit(1);
 	}
-	printf("\n");
-	if (logging) fprintf(logfile, "\n");
 
-	// Print each process's page table
-	for (int i = 0; i < n; i++)
+	// Attach shared memory
+	counters = (ossCounters_t*)shmat(ctr_id, 0, 0);
+	if (counters == (ossCounters_t*)-1)
 	{
-		if(!processTable[i].occupied) continue;
-		printf("P%d page table: [", i);
-		if (logging) fprintf(logfile,"P%d page table: [", i);
-		for (int j = 0; j < 32; j++)
-		{
-			printf(" %d", processTable[i].pageTable[j]);
-			if (logging) fprintf(logfile, " %d", processTable[i].pageTable[j]);
-		}
-		printf(" ]\n");
-		if (logging) fprintf(logfile, " ]\n");
+		fprintf(stderr, "Counters shared memory attach failed\n");
+		exit(1);
 	}
+	// Clear counters left by an earlier run, then mark segment as set up
+	memset((void*)counters, 0, sizeof(ossCounters_t));
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	counters->startTsc = counterCycles();
+	counters->startWallNs = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+	counters->pid = getpid();
+	std::atomic_thread_fence(std::memory_order_release);
+	counters->magic = CTR_MAGIC;
+}
 
-	printf("\n");
-	if (logging) fprintf(logfile, "\n");
-
+// Function to detach and remove counters segment
+void removeCounters()
+{
+	if (ctr_id == -1)
+		return;
+	if (shmdt(counters) == -1)
+	{
+		perror("shmdt counters failed");
+		exit(1);
+	}
+	if (shmctl(ctr_id, IPC_RMID, NULL) == -1)
+	{
+		perror("shmctl counters failed");
+		exit(1);
+	}
+	ctr_id = -1;
 }
 
-// Function to perform least recently used algorithm on frame table, passing in process's PCB index as parameter
-int lruReplacement(int slot)
+// Function to create shared memory segment holding one request ring and completion word per PCB slot
+void shareRing()
 {
-	// Get page number that process is waiting to load
-	unsigned page = processTable[slot].waitPage;
-	
-	// Attempt to find free frame
-	int frame = -1;
-	for (int i = 0; i < FRAME_NUM; i++)
+	// Generate key from same file as message queue
+	key_t ring_key = ftok("msgq.txt", 2);
+	if (ring_key == -1)
 	{
-		if (!frameTable[i].occupied)
-		{
-			frame = i;
-			break;
-		}
+		perror("ftok ring");
+		exit(1);
+	}
+	// Create shared memory
+	ring_id = shmget(ring_key, sizeof(ringHeader_t) + sizeof(ringSlot_t) * maxProc, IPC_CREAT | 0666);
+	if (ring_id == -1)
+	{
+		fprintf(stderr, "Ring shared memory get failed\n");
+		exit(1);
 	}
 
-	if (frame < 0) // If true, no free frame found
+	// Attach shared memory
+	ringHeader = (ringHeader_t*)shmat(ring_id, 0, 0);
+	if (ringHeader == (ringHeader_t*)-1)
 	{
-		// Take first frame in table and calculate time referenced
-		frame = 0;
-		long long oldest = (long long)frameTable[0].lastRefSec * 1000000000 + (long long)frameTable[0].lastRefNano;
-		// Increment through rest of frame table, updating oldest value to find frame used the longest time ago
-		for (int i = 1; i < FRAME_NUM; i++)
-		{
-			long long t = (long long)frameTable[i].lastRefSec * 1000000000 + (long long)frameTable[i].lastRefNano;
-			if (t < oldest)
-			{
-				oldest = t;
-				frame = i;
-			}
-		}
+		fprintf(stderr, "Ring shared memory attach failed\n");
+		exit(1);
+	}
+	ringSeg = ringSlots(ringHeader);
+	ringHeader->doorbell.store(0);
+	ringHeader->sleeping.store(0);
+	// Initialize every slot to empty
+	for (int i = 0; i < maxProc; i++)
+	{
+		ringReset(&ringSeg[i]);
+	}
+}
 
+// Function to detach and remove ring segment if it was created
+void removeRing()
+{
+	if (ringSeg == NULL)
+		return;
+	if (shmdt(ringHeader) == -1)
+	{
+		perror("shmdt ring failed");
+		exit(1);
+	}
+	if (shmctl(ring_id, IPC_RMID, NULL) == -1)
+	{
+		perror("shmctl ring failed");
+		exit(1);
+	}
+	ringHeader = NULL;
+	ringSeg = NULL;
+}
 
-		// Print frame swap
-		printf("oss: Clearing frame %d and swapping in p%d page %u\n", frame, slot, page);
-		if (logging)
-			fprintf(logfile, "oss: Clearing frame %d and swapping in p%d page %u\n", frame, slot, page);
+// Function to check for a request from any worker without blocking, returns true if msg was filled in
+bool receiveRequest(msgbuffer* msg)
+{
+	if (!useRing)
+	{
+		if (msgrcv(msqid, msg, sizeof(msgbuffer) - sizeof(long), 1, IPC_NOWAIT) > 0)
+			return true;
+		counterAdd(&counters->rcvEmpty, 1);
+		return false;
+	}
 
-		// Find pid of process who the frame belonged to, and remove page from process's table
-		pid_t victim = frameTable[frame].ownerPid;
-		int vicPage = frameTable[frame].pageNum;
-		for (int i = 0; i < MAX_PROC; i++)
+	// Check each occupied slot's ring once, starting after the slot that was served last
+	for (int i = 0; i < maxProc; i++)
+	{
+		int slot = (ringCursor + i) % maxProc;
+		if (processTable[slot].occupied && ringPop(&ringSeg[slot].request, msg))
 		{
-			if (processTable[i].occupied && processTable[i].pid == victim)
-			{
-				processTable[i].pageTable[vicPage] = -1;
-				break;
-			}
+			ringCursor = (slot + 1) % maxProc;
+			return true;
 		}
 	}
+	counterAdd(&counters->rcvEmpty, 1);
+	return false;
+}
 
-	// Update PCB and frame table to add new frame for process
-	processTable[slot].pageTable[page] = frame;
-	frameTable[frame].occupied = true;
-	frameTable[frame].ownerPid = processTable[slot].pid;
-	frameTable[frame].pageNum = page;
-	// Set dirty bit based on whether request was read or write
-	frameTable[frame].dirty = processTable[slot].waitIsWrite;
-	// Update time last referenced in frame table
-	frameTable[frame].lastRefSec = shm_ptr[0];
-	frameTable[frame].lastRefNano = shm_ptr[1];
+// Function to run in-process worker in slot up to its next request, posting it to the in-process queue. A worker
+// that decides to terminate posts a terminating message instead, same as a forked worker in discrete event mode.
+void inprocStep(int slot)
+{
+	refState_t* st = &inprocState[slot];
+	msgbuffer msg;
+	msg.mtype = 1;
+	msg.pid = processTable[slot].pid;
+	msg.granted = false;
+	msg.actNs = st->nAct;
+	msg.terminating = refCheckTerm(st, st->nAct);
+	if (!msg.terminating)
+		refNext(st, &msg.address, &msg.isWrite);
+	inprocQueue[(inprocHead + inprocCount) % maxProc] = msg;
+	inprocCount++;
+}
 
-	// Return found frame
-	return frame;
+// Signal handler for the watchdog, which only marks the run as truncated for the loops to end it outside the handler
+void signal_handler(int)
+{
+	truncated = 1;
 }
 
-// Signal handler to terminate all processes after 5 seconds in real time
-void signal_handler(int sig)
+// Function to terminate all processes once the watchdog's real time has passed, called by the loops once they see the
+// run was truncated
+void truncateRun()
 {
-	printf("5 seconds have passed, process(es) will now terminate.\n");
+	logPrintf(LOG_STATS, "%d seconds have passed, process(es) will now terminate.\n", options.watchdog);
 	pid_t pid;
 
-	// Loop through process table to find all processes still running and terminate
-	for (int i = 0; i < 18; i++)
+	// Loop through process table to find all processes still running and terminate. In-process workers have
+	// simulated pids that must never be sent a signal.
+	for (int i = 0; i < maxProc && !options.inproc; i++)
 	{
 		if(processTable[i].occupied)
 		{
@@ -306,8 +406,18 @@ void signal_handler(int sig)
 				kill(pid, SIGKILL);
 		}
 	}
+
+	// Export metrics of the truncated run
+	statsWrite(policy->name, clockNow(), totRefs, totFaults);
+
+	// Finish recording, so the references up to now can still be replayed, or unmap the trace being replayed
+	if (options.replay)
+		traceUnmap();
+	else
+		traceClose();
+
 	 // Detach from shared memory and remove it
-        if(shmdt(shm_ptr) == -1)
+        if(shmdt(simClock) == -1)
         {
                 perror("shmdt failed");
                 exit(1);
@@ -324,166 +434,1447 @@ void signal_handler(int sig)
                 perror("msgctl failed");
                 exit(1);
         }
+	removeRing();
+	removeCounters();
 
+	// Tell caller run did not finish
+	exit(EXIT_TRUNCATED);
+}
 
-	exit(1);
+// Function to take a request from the ring of worker in slot if any, or from any worker if slot is -1
+bool pollRequest(msgbuffer* msg, int slot)
+{
+	if (slot < 0 || !useRing)
+		return receiveRequest(msg);
+	if (ringPop(&ringSeg[slot].request, msg))
+		return true;
+	counterAdd(&counters->rcvEmpty, 1);
+	return false;
 }
 
-int main(int argc, char* argv[])
+// Function to block until a request arrives, sleeping instead of polling. Slot is the only worker a request can come
+// from, so only its ring is polled, or -1 if it may come from any worker.
+void waitRequest(msgbuffer* msg, int slot)
+{
+	// In-process workers post straight to the in-process queue, which holds a request for every worker oss waits on
+	if (options.inproc)
+	{
+		if (inprocCount == 0)
+		{
+			fprintf(stderr, "ERROR! OSS: no in-process request to wait for.\n");
+			exit(1);
+		}
+		*msg = inprocQueue[inprocHead];
+		inprocHead = (inprocHead + 1) % maxProc;
+		inprocCount--;
+		return;
+	}
+
+	if (!useRing)
+	{
+		// Retry if interrupted by a signal, unless it was the watchdog ending the run
+		while (msgrcv(msqid, msg, sizeof(msgbuffer) - sizeof(long), 1, 0) == -1)
+		{
+			if (errno != EINTR)
+			{
+				perror("msgrcv wait");
+				exit(1);
+			}
+			if (truncated)
+				truncateRun();
+		}
+		return;
+	}
+
+	while (true)
+	{
+		// Sleep below is cut short by the watchdog's signal, so the run ends here if it was truncated
+		if (truncated)
+			truncateRun();
+
+		// Poll rings briefly before going to sleep
+		for (int i = 0; i < ringSpin; i++)
+		{
+			if (pollRequest(msg, slot))
+				return;
+		}
+
+		// Announce sleep, then check once more so a request posted in between is not missed
+		unsigned seen = ringPrepareSleep(ringHeader);
+		if (pollRequest(msg, slot))
+		{
+			ringCancelSleep(ringHeader);
+			return;
+		}
+		ringSleep(ringHeader, seen);
+	}
+}
+
+// Function to add grant for worker in slot to the batch sent at the end of the loop iteration
+void queueGrant(int slot, pid_t pid)
 {
-	// Signal that will terminate program after 5 sec (real time)
-	signal(SIGALRM, signal_handler);
-	alarm(5);
+	grantSlots[grantCount] = slot;
+	grantPids[grantCount] = pid;
+	grantCount++;
+}
 
-	key_t key; // Key to access queue
+// Function to send every queued grant through the transport in use
+void flushGrants()
+{
+	buf.granted = true;
+	buf.terminating = false;
+	// Tell workers the time of the grant, used as their current time in discrete event mode
+	buf.actNs = clockNow();
 
-	// Create file to track message queue
-	system("touch msgq.txt");
+	// Count time from request to grant of every request serviced since the last flush
+	statsGrant(grantSlots, grantCount, buf.actNs);
 
-	// Get key for message queue
-	if ((key = ftok("msgq.txt", 1)) == -1)
+	// Resume each granted in-process worker at grant time until it posts its next request
+	if (options.inproc)
 	{
-		perror("ftok");
-		exit(1);
+		for (int i = 0; i < grantCount; i++)
+		{
+			refSchedule(&inprocState[grantSlots[i]], buf.actNs);
+			inprocStep(grantSlots[i]);
+		}
+		grantCount = 0;
+		return;
+	}
+	if (useRing)
+	{
+		// Publish every reply first, then wake only the workers that went to sleep
+		for (int i = 0; i < grantCount; i++)
+		{
+			buf.mtype = grantPids[i];
+			buf.pid = grantPids[i];
+			ringPublish(&ringSeg[grantSlots[i]], &buf);
+		}
+		for (int i = 0; i < grantCount; i++)
+		{
+			ringWake(&ringSeg[grantSlots[i]]);
+		}
+		grantCount = 0;
+		return;
 	}
 
-	// Create message queue
-	if ((msqid = msgget(key, PERMS | IPC_CREAT)) == -1)
+	for (int i = 0; i < grantCount; i++)
 	{
-		perror("msgget in parent\n");
-		exit(1);
-	}	
+		buf.mtype = grantPids[i];
+		buf.pid = grantPids[i];
+		if (msgsnd(msqid, &buf, sizeof(msgbuffer) - sizeof(long), 0) == -1)
+		{
+			perror("msgsnd grant");
+			exit(1);
+		}
+	}
+	grantCount = 0;
+}
 
-	printf("Message queue set up\n");
+// Function to print formatted process table, each process's page table,  and frame table to console. Will also print to logfile if necessary.
+void printInfo(int n)
+{
+	unsigned long long startCycles = counterCycles();
+	counterAdd(&counters->printCalls, 1);
 
-	// Structure to hold values for options in command line argument
-	options_t options;
+	// Export current percentiles, even if tables are not printed
+	statsTick(clockNow(), totRefs, totFaults, waitQueue.size(), running);
 
-	// Set default values
-	options.proc = 1;
-	options.simul = 1;
-	options.interval = 0;
+	// Print only what changed since the last print, which keeps the copy used for full snapshots current even if nothing
+	// is printed
+	if (snapEnabled())
+	{
+		snapTick(clockNow());
+		counterAdd(&counters->printCycles, counterCycles() - startCycles);
+		return;
+	}
 
+	// Skip walking the tables if they would not be printed
+	if (!logEnabled(LOG_TABLES))
+	{
+		counterAdd(&counters->printCycles, counterCycles() - startCycles);
+		return;
+	}
 
-	// Values to keep track of child iterations
-	int total = 0; // Total number of child processes spawned
-	running = 0; // Number of simultaneous processes in system
-	int totRefs = 0; // Total number of memory reference requests received
-	int totFaults = 0; // Total number of page faults
+	logPrintf(LOG_TABLES, "\n");
 
-	const char optstr[] = "hn:s:i:f"; // Options h, n, s, t, i, f
-	char opt;
-	
-	// Parse command line arguments with getopt
-	while ( (opt = getopt(argc, argv, optstr)) != -1)
+	// Print process control block 	
+	long long nowNs = clockNow();
+	logPrintf(LOG_TABLES, "OSS PID: %d SysClockS: %u SysClockNano: %u\n Process Table:\n", getpid(), clockSec(nowNs), clockNano(nowNs));
+	logPrintf(LOG_TABLES, "Entry\tOccupied\tPID\tStartS\tStartNs\n");
+
+	for (int i = 0; i < n; i++)
 	{
-		switch(opt)
+		// Print table only if occupied by process
+		if (processTable[i].occupied == 1)
 		{
-			case 'h': // Help
-				// Prints usage
-				print_usage(argv[0]);
-				return EXIT_SUCCESS;
-			case 'n': // Total amount of processes
-				// Check if n's argument starts with '-'
-				if (optarg[0] == '-')
-				{
-					// Check if next character starts with other option, meaning no argument given for n and another option given
-					if (optarg[1] == 's' || optarg[1] == 'i' || optarg[1] == 'f' ||  optarg[1] == 'h')
-					{
-						// Print an error statement, print usage, and exit program
-						fprintf(stderr, "Error! Option n requires an argument.\n");
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-					else // Means argument is not another option, but is still invalid input
-					{
-						fprintf(stderr, "Error! Invalid input.\n");
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-				}
-				// Loop to ensure all characters in n's argument are digits
-				for (int i = 0; optarg[i] != '\0'; i++)
-				{
-					if (!isdigit(optarg[i]))
-					{
-						// If non digit is found, print error statement, print usage, and exit program
-						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-				}
+			logPrintf(LOG_TABLES, "%d\t%d\t\t%d\t%u\t%u%s\n", i, processTable[i].occupied, processTable[i].pid, processTable[i].startSeconds, processTable[i].startNano, loadSuspended(i) ? "\tsuspended" : "");
+		}
+	}
+	// Show how much memory the active processes need
+	if (loadEnabled())
+	{
+		logPrintf(LOG_TABLES, "%d active processes, working sets of %d of %d frames\n", loadActive(), loadDemand(), frameNum);
+	}
+	logPrintf(LOG_TABLES, "\n");
 
-				// Set proc to optarg, ensure no more than 100 proc,  and break
-				options.proc = atoi(optarg);
-				if (options.proc > 100)
-				{
-					fprintf(stderr, "Warning: no more than 100 total processes allowed, -n will be set to 100\n");
-					options.proc = 100;
-				}
-				break;
-			
-			case 's': // Total amount of processes that can run simultaneously
-				// Checks if s's argument starts with '-'
-				if (optarg[0] == '-')
-				{
-					// Check if next character starts with other option, meaning no argument given for n and another option given
-					if (optarg[1] == 'n' || optarg[1] == 'i' || optarg[1] == 'f' ||  optarg[1] == 'h')
-					{
-						// Print an error statement, print usage, and exit program
-						fprintf(stderr, "Error! Option s requires an argument.\n");
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-					else // Means argument is not another option, but is still invalid input
-					{
-						fprintf(stderr, "Error! Invalid input.\n");
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-				}
-				// Loop to ensure all characters in s's argument are digits
-				for (int i = 0; optarg[i] != '\0'; i++)
-				{
-					if (!isdigit(optarg[i]))
-					{
-						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
-						print_usage(argv[0]);
-						return EXIT_FAILURE;
-					}
-				}
+	// Print frame table
+	logPrintf(LOG_TABLES, "Current memory layout at time %u:%09u is:\n", clockSec(nowNs), clockNano(nowNs));
 
-				// Set simul to optarg and break
-				options.simul = atoi(optarg);
-				if (options.simul > 18)
-				{
-					fprintf(stderr, "Error! Value entered for options s cannot exceed 18. %d > 18.\n", options.simul);
-					print_usage(argv[0]);
-					return EXIT_FAILURE;
-				}
-				break;
+	// Large frame tables would take longer to print than to simulate, so only print how full they are
+	if (frameNum > PRINT_FRAMES)
+	{
+		logPrintf(LOG_TABLES, "%d of %d frames occupied, %d dirty\n", bitCount(frameTable.occupied, frameNum), frameNum, bitCount(frameTable.dirty, frameNum));
+	}
+	else
+	{
+		logPrintf(LOG_TABLES, "      %-8s %-8s %-8s %-12s\n", "Occupied", "DirtyBit", "LastRefS", "LastRefNano");
+	}
 
-			case 'i':
-				// Checks if i's argument starts with '-'
-				if (optarg[0] == '-')
-				{
-					// Checks if next character is character of other option, meaning no argument given for i and another option given
+	for (int i = 0; i < frameNum && frameNum <= PRINT_FRAMES; i++)
+	{
+		const char* occ = "No";
+		if (bitTest(frameTable.occupied, i))
+			occ = "Yes";
+		logPrintf(LOG_TABLES, "Frame %d: %-8s %-8d %-8lld %-12lld\n", i, occ, bitTest(frameTable.dirty, i), frameTable.lastRefNs[i] / 1000000000, frameTable.lastRefNs[i] % 1000000000);
+	}
+	if (hugeEnabled())
+		logPrintf(LOG_TABLES, "%d large pages of %d pages mapped\n", hugeMapped, hugePages());
+	// Show how many frames each memory node has free
+	for (int i = 0; i < numaNodes(); i++)
+	{
+		logPrintf(LOG_TABLES, "Node %d: %d frames free\n", i, numaFree(i));
+	}
+	logPrintf(LOG_TABLES, "\n");
+
+	// Print each process's page table
+	for (int i = 0; i < n; i++)
+	{
+		if(!processTable[i].occupied) continue;
+		logPrintf(LOG_TABLES, "P%d page table: [", i);
+		for (int j = 0; j < pageCount; j++)
+		{
+			// Large page tables only print resident pages, as page:frame
+			if (pageCount > PRINT_PAGES)
+			{
+				int frame = ptGet(i, j);
+				if (frame == -1)
+					continue;
+				logPrintf(LOG_TABLES, " %d:%d", j, frame);
+				continue;
+			}
+			logPrintf(LOG_TABLES, " %d", ptGet(i, j));
+		}
+		logPrintf(LOG_TABLES, " ]\n");
+	}
+
+	logPrintf(LOG_TABLES, "\n");
+	counterAdd(&counters->printCycles, counterCycles() - startCycles);
+}
+
+// Function to calculate and print final statistics to console, and to logfile if necessary
+void printStats(long long totRefs, long long totFaults)
+{
+	// Update time for statistics
+	long long currTimeNs = clockNow();
+
+	// Calculate statistics
+	double refsPerSec = 0.0;
+	if (currTimeNs > 0)
+		refsPerSec = ((double)totRefs * 1000000000) / currTimeNs;
+
+	double faultRate;
+	if (totRefs > 0)
+		faultRate = (100.0 * totFaults) / totRefs;
+	else faultRate = 0.0;
+
+	// Average real time spent choosing and loading a frame for each page fault
+	double nsPerFault = 0.0;
+	if (totFaults > 0)
+		nsPerFault = (double)replaceNs / totFaults;
+
+	// Real time of run, and CPU time and context switches of oss and every worker it has waited for
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	double wallSec = (ts.tv_sec * 1000000000LL + ts.tv_nsec - startWallNs) / 1e9;
+	double refsPerWallSec = wallSec > 0 ? totRefs / wallSec : 0.0;
+	struct rusage self, children;
+	getrusage(RUSAGE_SELF, &self);
+	getrusage(RUSAGE_CHILDREN, &children);
+	double userSec = self.ru_utime.tv_sec + children.ru_utime.tv_sec + (self.ru_utime.tv_usec + children.ru_utime.tv_usec) / 1e6;
+	double sysSec = self.ru_stime.tv_sec + children.ru_stime.tv_sec + (self.ru_stime.tv_usec + children.ru_stime.tv_usec) / 1e6;
+
+	logPrintf(LOG_STATS, "\n----Simulation Statistics----\n");
+	logPrintf(LOG_STATS, "Replacement policy: %s\n", policy->name);
+	logPrintf(LOG_STATS, "Total memory references: %lld\n", totRefs);
+	logPrintf(LOG_STATS, "Total page faults: %lld\n", totFaults);
+	logPrintf(LOG_STATS, "Fault rate: %.2f%%\n", faultRate);
+	logPrintf(LOG_STATS, "References per sec of system time: %.2f\n", refsPerSec);
+	logPrintf(LOG_STATS, "References per sec of real time: %.2f\n", refsPerWallSec);
+	logPrintf(LOG_STATS, "Real time: %.3f s\n", wallSec);
+	logPrintf(LOG_STATS, "CPU time: %.3f s user, %.3f s system\n", userSec, sysSec);
+	logPrintf(LOG_STATS, "Context switches: %ld voluntary, %ld involuntary\n", self.ru_nvcsw + children.ru_nvcsw,
+		self.ru_nivcsw + children.ru_nivcsw);
+	// Shards do not time requests or fault service, but report what each of them serviced
+	if (options.shards > 0)
+		shardPrintStats();
+	else
+	{
+		logPrintf(LOG_STATS, "Replacement time per fault: %.1f ns\n", nsPerFault);
+		logPrintf(LOG_STATS, "Hit grant time p50/p99/max: %lld/%lld/%lld ns system, %lld/%lld/%lld ns real\n",
+			histPercentile(&hitSimHist, 50), histPercentile(&hitSimHist, 99), hitSimHist.max,
+			histPercentile(&hitWallHist, 50), histPercentile(&hitWallHist, 99), hitWallHist.max);
+		logPrintf(LOG_STATS, "Fault service time p50/p99/max: %lld/%lld/%lld ns system, %lld/%lld/%lld ns real\n",
+			histPercentile(&faultSimHist, 50), histPercentile(&faultSimHist, 99), faultSimHist.max,
+			histPercentile(&faultWallHist, 50), histPercentile(&faultWallHist, 99), faultWallHist.max);
+		logPrintf(LOG_STATS, "Process fault rate p50/p99/max: %.4f%%/%.4f%%/%.4f%%\n", histPercentile(&procFaultHist, 50) / 10000.0,
+			histPercentile(&procFaultHist, 99) / 10000.0, procFaultHist.max / 10000.0);
+	}
+
+	logPrintf(LOG_STATS, "Page tables (%s): %lld bytes peak\n", ptName(pageTableKind), ptPeakBytes);
+	if (prefetchEnabled())
+	{
+		logPrintf(LOG_STATS, "Prefetch %s: %lld pages loaded, %lld used (accuracy %.2f%%), %lld evicted unused, %lld resident pages evicted for them\n",
+			options.prefetch, prefetchLoaded, prefetchUsed, prefetchLoaded > 0 ? (100.0 * prefetchUsed) / prefetchLoaded : 0.0,
+			prefetchWasted, prefetchEvicted);
+	}
+	if (swapEnabled())
+	{
+		logPrintf(LOG_STATS, "Swap device %s: %lld reads, %lld prefetch reads, %lld writebacks of dirty victims, %lld frames cleaned ahead of eviction\n",
+			options.swap, swapReads, swapPrefetches, swapWrites, swapCleaned);
+		logPrintf(LOG_STATS, "Swap device busy %.2f%% of system time, average read time %.0f ns\n",
+			currTimeNs > 0 ? (100.0 * swapBusyNs) / currTimeNs : 0.0, swapReads > 0 ? (double)swapReadNs / swapReads : 0.0);
+	}
+	if (numaEnabled())
+	{
+		long long refs = numaLocalRefs + numaRemoteRefs;
+		logPrintf(LOG_STATS, "NUMA %d nodes (%s placement): %lld local and %lld remote references (%.2f%% local), %lld pages loaded local and %lld remote, %lld pages migrated\n",
+			numaNodes(), numaName(numaConfig.placement), numaLocalRefs, numaRemoteRefs, refs > 0 ? (100.0 * numaLocalRefs) / refs : 0.0,
+			numaLocalLoads, numaRemoteLoads, numaMigrations);
+	}
+	if (sharedPages > 0)
+	{
+		logPrintf(LOG_STATS, "Shared pages %d: %lld references mapped a resident shared page without a fault, %lld copy-on-write splits, %lld mappings cleared by evicting shared frames, peak %d frames saved by sharing\n",
+			sharedPages, shareMaps, shareSplits, shareUnmaps, sharePeakSaved);
+	}
+	if (hugeEnabled())
+	{
+		logPrintf(LOG_STATS, "Large pages %s of %d pages: %lld promoted copying %lld pages, %lld loaded whole by one fault, %lld demoted, %lld given up for want of a run, peak %d mapped saving %lld page table entries\n",
+			options.huge, hugePages(), hugePromotions, hugeCopies, hugeFaults, hugeDemotions, hugeNoRun, hugePeakMapped,
+			(long long)hugePeakMapped * (hugePages() - 1));
+	}
+	if (loadEnabled())
+	{
+		logPrintf(LOG_STATS, "Load control %s: %lld spawns held back for %.3f s, %lld suspensions freeing %lld frames, %lld resumptions, %.3f s of process time suspended, peak working set %d of %d frames\n",
+			options.load, loadDeferred, loadDeferNs / 1e9, loadSuspensions, loadFreed, loadResumes, loadSuspendedNs / 1e9, loadPeakDemand, frameNum);
+	}
+	if (snapEnabled())
+	{
+		logPrintf(LOG_STATS, "Snapshots %s: %lld full snapshots of %lld bytes written to %s\n", options.snapshot, snapWritten, snapBytes, SNAP_FILE);
+	}
+	if (tlbEnabled())
+	{
+		long long lookups = tlbHits + tlbMisses;
+		logPrintf(LOG_STATS, "TLB %s: %lld hits, %lld misses, hit rate %.2f%%, %lld flushes\n", options.tlb, tlbHits,
+			tlbMisses, lookups > 0 ? (100.0 * tlbHits) / lookups : 0.0, tlbFlushes);
+	}
+
+	// Write full histograms if exporting
+	statsWrite(policy->name, currTimeNs, totRefs, totFaults);
+}
+
+// Function to replay trace recorded with -r through the paging core instead of launching workers. References are
+// serviced in recorded order, with the clock moved forward to the time each one was made and advanced by the same costs
+// as a live run. Faults are serviced as soon as they occur.
+void replayTrace(long long* totRefs, long long* totFaults)
+{
+	traceHeader_t header;
+	const traceRec_t* recs = traceOpen(TRACE_FILE, &header);
+	size_t count = header.count;
+
+	// Recorded addresses only map to the recorded pages with the same address space layout
+	if (header.pageSize != options.pageSize || header.pageCount != (unsigned)options.pages)
+	{
+		fprintf(stderr, "ERROR! OSS: %s was recorded with %u pages of %u bytes, replay it with -g %u -z %u.\n", TRACE_FILE,
+			header.pageCount, header.pageSize, header.pageCount, header.pageSize);
+		exit(1);
+	}
+
+	// Optimal policy needs position of next reference to the same page for every reference, found by scanning backwards
+	if (strcmp(policy->name, "opt") == 0)
+	{
+		long long refCount = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (recs[i].type == TR_REF)
+				refCount++;
+		}
+		vector<long long> nextUse(refCount);
+		unordered_map<unsigned long long, long long> lastSeen;
+		long long idx = refCount;
+		for (size_t i = count; i-- > 0; )
+		{
+			if (recs[i].type != TR_REF)
+				continue;
+			idx--;
+			unsigned long long key = pageKey(recs[i].pid, recs[i].address / pageSize);
+			auto it = lastSeen.find(key);
+			nextUse[idx] = it == lastSeen.end() ? LLONG_MAX : it->second;
+			lastSeen[key] = idx;
+		}
+		optSetFuture(nextUse);
+	}
+
+	logPrintf(LOG_STATS, "oss: Replaying %zu records from %s with policy %s\n", count, TRACE_FILE, policy->name);
+
+	// Recorded pids are bound to process table slots on their first reference
+	for (size_t i = 0; i < count; i++)
+	{
+		if (truncated)
+			truncateRun();
+
+		const traceRec_t* rec = &recs[i];
+		int slot = slotOf(rec->pid);
+
+		// Move clock to time record was made, never backwards since costs may already have passed it
+		long long currTimeNs = clockNow();
+		if (rec->timeNs > currTimeNs)
+			clockSet(rec->timeNs);
+
+		// Termination, release process's frames and slot
+		if (rec->type == TR_EXIT)
+		{
+			if (slot >= 0)
+			{
+				statsExit(slot, rec->pid);
+				releaseProcess(slot);
+				slotFree(slot);
+			}
+			continue;
+		}
+
+		// Recorded with a larger address space than the one being simulated
+		unsigned page = rec->address / pageSize;
+		if (page >= (unsigned)pageCount)
+		{
+			fprintf(stderr, "ERROR! OSS: address %u in %s out of range, use options g and z.\n", rec->address, TRACE_FILE);
+			exit(1);
+		}
+
+		// First reference of process, place it in a free slot
+		if (slot < 0)
+		{
+			slot = slotAlloc();
+			if (slot < 0)
+			{
+				fprintf(stderr, "ERROR! OSS: more than %d processes active in %s, use option s.\n", maxProc, TRACE_FILE);
+				exit(1);
+			}
+			slotBind(slot, rec->pid);
+			processTable[slot].startSeconds = clockSec(clockNow());
+			processTable[slot].startNano = clockNano(clockNow());
+		}
+
+		(*totRefs)++;
+		long long reqNs = clockNow();
+		int frame = pageLookup(slot, page);
+		if (frame == -1 && sharedPages > 0)
+			frame = pageShared(slot, page);
+		statsRequest(slot, reqNs, frame == -1, 0);
+		if (frame != -1) // Hit, add same overhead as granting live request
+		{
+			addOverhead();
+			clockAdd(100);
+			frame = pageHit(slot, frame, rec->isWrite);
+		}
+		else // Page fault, wait for swap device or fixed fault latency then load page, same as a live fault
+		{
+			(*totFaults)++;
+			long long nowNs = clockNow();
+			long long doneNs;
+			if (swapEnabled())
+				doneNs = swapRead(nowNs);
+			else
+			{
+				doneNs = nowNs + FAULT_READ_NS;
+				if (rec->isWrite)
+					doneNs += FAULT_WRITE_NS;
+			}
+			clockAdd(doneNs - nowNs);
+			processTable[slot].waitPage = page;
+			processTable[slot].waitAddress = rec->address;
+			processTable[slot].waitIsWrite = rec->isWrite;
+			pageFault(slot);
+			addOverhead();
+		}
+		// Replayed references are granted as soon as they are serviced
+		statsGrant(&slot, 1, clockNow());
+	}
+	traceUnmap();
+}
+
+// Function to record a reference or termination of process in slot to the trace, if recording
+void traceRecord(int type, int slot, long long timeNs, unsigned address, bool isWrite, bool fault, int frame)
+{
+	if (!options.record)
+		return;
+	traceRec_t rec;
+	memset(&rec, 0, sizeof(rec));
+	rec.timeNs = timeNs;
+	rec.pid = processTable[slot].pid;
+	rec.slot = slot;
+	rec.address = address;
+	rec.frame = frame;
+	rec.victimPid = fault ? lastVictimPid : -1;
+	rec.victimPage = fault ? lastVictimPage : -1;
+	rec.type = type;
+	rec.isWrite = isWrite;
+	rec.fault = fault;
+	traceAppend(&rec);
+}
+
+// Function to clear a finished process from the process table and frame table
+void reapProcess(pid_t pid)
+{
+	// Find process's location in process table
+	int indx = slotOf(pid);
+	if (indx < 0)
+		return;
+
+	// Count process's fault rate, then clear its entires in PCB and frame table. Shards keep their own frames, so
+	// the process's shard releases them instead.
+	if (options.shards > 0)
+		shardDetach(indx);
+	else
+	{
+		statsExit(indx, pid);
+		releaseProcess(indx);
+	}
+	loadExit(indx, clockNow());
+	if (parked[indx])
+	{
+		parked[indx] = false;
+		parkedCount--;
+	}
+
+	// Record termination so replay releases the same frames
+	traceRecord(TR_EXIT, indx, clockNow(), 0, false, false, -1);
+
+	// Mark finished process as unoccupied in process table
+	slotFree(indx);
+	// Decrement total processes running
+	running--;
+}
+
+// Function to reap every child process that has finished, without blocking
+void reapWorkers()
+{
+	pid_t pid;
+	int status;
+	unsigned long long startCycles = counterCycles();
+	counterAdd(&counters->reapCalls, 1);
+	while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+	{
+		reapProcess(pid);
+	}
+	counterAdd(&counters->reapCycles, counterCycles() - startCycles);
+}
+
+// Function to fork and exec a new worker into a free slot of the process table, returns the slot
+int spawnWorker()
+{
+	// Take free slot in process table for new child, there is always one while running is below simul
+	int newSlot = slotAlloc();
+	// Clear slot's ring before the child can post to it
+	if (useRing)
+		ringReset(&ringSeg[newSlot]);
+
+	// In-process worker, give it a simulated pid and start its reference stream at current time
+	if (options.inproc)
+	{
+		total++;
+		running++;
+		incrementClock();
+
+		slotBind(newSlot, inprocNextPid++);
+		loadStart(newSlot);
+		processTable[newSlot].startSeconds = clockSec(clockNow());
+		processTable[newSlot].startNano = clockNano(clockNow());
+		refInit(&inprocState[newSlot], processTable[newSlot].pid, clockNow(), &refConfig);
+		inprocStep(newSlot);
+		return newSlot;
+	}
+
+	//Fork new child
+	pid_t childPid = fork();
+	if (childPid == 0) // Child process
+	{
+		// Create array of arguments to pass to exec. "./worker" is the program to execute, followed by the transport
+		// to use, the PCB slot whose ring it posts to, its address space and reference generator and the simulation mode,
+		// and NULL shows it is the end of the argument list
+		char slotArg[16];
+		snprintf(slotArg, sizeof(slotArg), "%d", newSlot);
+		char pagesArg[16];
+		snprintf(pagesArg, sizeof(pagesArg), "%d", pageCount);
+		char sizeArg[16];
+		snprintf(sizeArg, sizeof(sizeArg), "%u", pageSize);
+		char pctArg[16];
+		snprintf(pctArg, sizeof(pctArg), "%d", options.writePct);
+		char* args[18];
+		int n = 0;
+		args[n++] = (char*)"./worker";
+		args[n++] = (char*)"-t";
+		args[n++] = (char*)(useRing ? "ring" : "msgq");
+		args[n++] = (char*)"-k";
+		args[n++] = slotArg;
+		args[n++] = (char*)"-g";
+		args[n++] = pagesArg;
+		args[n++] = (char*)"-z";
+		args[n++] = sizeArg;
+		args[n++] = (char*)"-w";
+		args[n++] = (char*)options.gen;
+		args[n++] = (char*)"-W";
+		args[n++] = pctArg;
+		if (options.des)
+			args[n++] = (char*)"-d";
+		args[n] = NULL;
+		// Replace current process with "./worker" process and pass options as parameters
+		execvp(args[0], args);
+		// If this prints, means exec failed
+		// Prints error message and exits
+		fprintf(stderr, "Exec failed, terminating!\n");
+		exit(1);
+	}
+
+	// Parent process
+	// Increment total created processes and running processes
+	total++;
+	running++;
+
+	// Increment clock
+	incrementClock();
+
+	// Update table with new child info
+	slotBind(newSlot, childPid);
+	loadStart(newSlot);
+	processTable[newSlot].startSeconds = clockSec(clockNow());
+	processTable[newSlot].startNano = clockNano(clockNow());
+	return newSlot;
+}
+
+// Function to service a memory request from a worker. A hit is granted right away and returns true, a page fault
+// puts the worker in the wait queue and returns false.
+bool handleRequest(msgbuffer* msg)
+{
+	// Find process who sent message in PCB
+	int slot = slotOf(msg->pid);
+	if (slot < 0)
+	{
+		fprintf(stderr, "ERROR! OSS: request from pid %d, which is not in the process table.\n", msg->pid);
+		exit(1);
+	}
+
+	// Hold request of suspended process until load control resumes it
+	if (loadSuspended(slot))
+	{
+		parkedMsg[slot] = *msg;
+		parked[slot] = true;
+		parkedCount++;
+		return false;
+	}
+
+	// Increment total reference requests
+	totRefs++;
+
+	// Calculate page number from address sent, ensuring it is not greater than max amount of entries
+	unsigned page = msg->address / pageSize;
+	if (page >= (unsigned)pageCount)
+	{
+		fprintf(stderr, "ERROR! OSS: bad address %u. Page %u out of range.\n", msg->address, page);
+		exit(1);
+	}
+
+	// Determine if request was read or write and set to string for printing
+	const char* op;
+	if (msg->isWrite) op = "write";
+	else op = "read";
+
+	// Print incoming request
+	long long nowNs = clockNow();
+	logPrintf(LOG_REFS, "oss: P%d requesting %s of address %u at time %u:%09u\n", slot, op, msg->address, clockSec(nowNs), clockNano(nowNs));
+
+	// Check page table entry, mapping a shared page another process has resident without a fault
+	int frame = pageLookup(slot, page);
+	if (frame == -1 && sharedPages > 0)
+		frame = pageShared(slot, page);
+	statsRequest(slot, nowNs, frame == -1, waitQueue.size());
+	loadRef(slot, page, frame == -1);
+	if (frame != -1) // Determine if frame found in table
+	{
+		// Add overhead
+		addOverhead();
+		// Add additional 100ns for accessing
+		clockAdd(100);
+
+		// Update last reference time and dirty bit in frame table
+		frame = pageHit(slot, frame, msg->isWrite);
+
+		// Record hit so the same workload can be replayed with another policy
+		nowNs = clockNow();
+		traceRecord(TR_REF, slot, nowNs, msg->address, msg->isWrite, false, frame);
+
+		// Queue message to worker, granting requst
+		queueGrant(slot, msg->pid);
+
+		// Determine whether it is a read or write
+		if (msg->isWrite)
+		{
+			// Print write
+			logPrintf(LOG_REFS, "oss: Address %u in frame %d, writing data to frame at time %u:%09u\n", msg->address, frame, clockSec(nowNs), clockNano(nowNs));
+		}
+		else
+		{
+			// Print read
+			logPrintf(LOG_REFS, "oss: Address %u in frame %d, giving data to P%d at time %u:%09u\n", msg->address, frame, slot, clockSec(nowNs), clockNano(nowNs));
+		}
+		return true;
+	}
+
+	// Page fault
+	// Increment total page faults
+	totFaults++;
+
+	// Print page fault
+	logPrintf(LOG_REFS, "oss: Address %u is not in a frame, pagefault\n", msg->address);
+
+	// Mark process in PCB table as waiting
+	processTable[slot].waiting = true;
+	processTable[slot].waitPage = page;
+	processTable[slot].waitAddress = msg->address;
+	processTable[slot].waitIsWrite = msg->isWrite;
+	processTable[slot].waitSec = clockSec(nowNs);
+	processTable[slot].waitNano = clockNano(nowNs);
+
+	// Add process to wait queue, keyed on time its page will have been read from the swap device, or its fixed fault
+	// latency will have passed
+	long long doneNs;
+	if (swapEnabled())
+		doneNs = swapRead(nowNs);
+	else
+	{
+		doneNs = nowNs + FAULT_READ_NS;
+		if (msg->isWrite)
+			doneNs += FAULT_WRITE_NS;
+	}
+	waitQueue.push(waitEntry_t(doneNs, slot));
+	return false;
+}
+
+// Function to load the page a process was waiting on once its fault latency has passed, and grant its request
+void completeFault(int slot)
+{
+	// Load faulted page into frame, using replacement policy if no frame is free
+	int frame = pageFault(slot);
+	processTable[slot].waiting = false;
+
+	// Record fault at time it was requested, in the order the pager loaded it
+	traceRecord(TR_REF, slot, processTable[slot].waitSec * 1000000000 + processTable[slot].waitNano,
+		processTable[slot].waitAddress, processTable[slot].waitIsWrite, true, frame);
+
+	// Add overhead of loading page
+	addOverhead();
+
+	// Queue message to worker, granting requesst
+	queueGrant(slot, processTable[slot].pid);
+
+	// Determine if read or write for printing
+	const char* opr = "read";
+	if(processTable[slot].waitIsWrite)
+	{
+		// If write, print and add additional time (dirty bit set in LRU algorithm)
+		opr = "write";
+		logPrintf(LOG_REFS, "oss: Dirty bit of frame %d set, adding additional time to the clock\n", frame);
+		addOverhead();
+	}
+
+	// Determine address of process and print
+	unsigned addr = processTable[slot].waitPage * pageSize;
+	logPrintf(LOG_REFS, "oss: Indicating to P%d that %s has happened to the address %u\n", slot, opr, addr);
+}
+
+// Function to suspend the newest processes while memory is overcommitted, paging out their frames, and resume the
+// oldest suspended process once it fits again, servicing the request it made while suspended. Returns amount of
+// resumed processes whose request was granted right away.
+int loadControl()
+{
+	if (!loadEnabled())
+		return 0;
+
+	int slot;
+	while ((slot = loadPickSuspend()) != -1)
+	{
+		long long nowNs = clockNow();
+		loadSuspend(slot, nowNs);
+		int freed = pageOutProcess(slot);
+		loadFreed += freed;
+		logPrintf(LOG_REFS, "oss: Suspending P%d at time %u:%09u, %d frames freed, working set of active processes now %d of %d frames\n",
+			slot, clockSec(nowNs), clockNano(nowNs), freed, loadDemand(), frameNum);
+	}
+
+	int granted = 0;
+	while ((slot = loadPickResume(clockNow())) != -1)
+	{
+		long long nowNs = clockNow();
+		loadResume(slot, nowNs);
+		logPrintf(LOG_REFS, "oss: Resuming P%d at time %u:%09u, working set of active processes now %d of %d frames\n",
+			slot, clockSec(nowNs), clockNano(nowNs), loadDemand(), frameNum);
+		if (parked[slot])
+		{
+			parked[slot] = false;
+			parkedCount--;
+			if (handleRequest(&parkedMsg[slot]))
+				granted++;
+		}
+	}
+	return granted;
+}
+
+// Event types for discrete event mode
+#define EV_SPAWN 0 // Launch next worker
+#define EV_ACT 1 // Worker makes the memory request it reported
+#define EV_PRINT 2 // Print tables
+
+// Structure for a scheduled event in discrete event mode
+typedef struct
+{
+	long long timeNs; // System time event happens
+	int type; // One of EV_SPAWN, EV_ACT or EV_PRINT
+	msgbuffer msg; // Request worker will make, for EV_ACT
+} desEvent_t;
+
+// Comparison putting earliest event at top of priority queue
+struct desLater
+{
+	bool operator()(const desEvent_t& a, const desEvent_t& b) const
+	{
+		return a.timeNs > b.timeNs;
+	}
+};
+
+// Function to run simulation as discrete events instead of stepping the clock. Workers tell oss the time of their next
+// request and then sleep until it is granted, so oss knows every future event once all running workers have reported.
+// It then moves the clock straight to the earliest event, which is a spawn, a worker request, a fault completion or a
+// table print.
+void runDiscreteEvent()
+{
+	// At most one request per PCB slot, one spawn and one print are ever scheduled, so reserve room for all of them
+	vector<desEvent_t> eventStore;
+	eventStore.reserve(maxProc + 2);
+	priority_queue<desEvent_t, vector<desEvent_t>, desLater> events(desLater(), std::move(eventStore));
+	desEvent_t ev;
+	int unreported = 0; // Running workers whose next request or termination has not been received yet
+	int awaitSlot = -1; // Slot of the only unreported worker, -1 if several are unreported
+	long long currTimeNs = clockNow();
+	long long nSpawnT = currTimeNs + options.interval; // Earliest time next worker may be launched
+	bool spawnScheduled = false; // True if a spawn event is in the queue
+
+	// Schedule first spawn and first table print
+	ev.type = EV_SPAWN;
+	ev.timeNs = nSpawnT;
+	events.push(ev);
+	spawnScheduled = true;
+	ev.type = EV_PRINT;
+	ev.timeNs = currTimeNs + 1000000000;
+	events.push(ev);
+
+	while (total < options.proc || running > 0)
+	{
+		if (truncated)
+			truncateRun();
+
+		// Wait until every running worker has reported, since none of them can act before telling oss when
+		while (unreported > 0)
+		{
+			msgbuffer msg;
+			waitRequest(&msg, unreported == 1 ? awaitSlot : -1);
+			counterAdd(&counters->drained, 1);
+			unreported--;
+
+			if (msg.terminating)
+			{
+				// Wait for forked worker to finish exiting, then clear it from the tables
+				int status;
+				unsigned long long startCycles = counterCycles();
+				counterAdd(&counters->reapCalls, 1);
+				if (!options.inproc)
+					waitpid(msg.pid, &status, 0);
+				reapProcess(msg.pid);
+				counterAdd(&counters->reapCycles, counterCycles() - startCycles);
+
+				// A slot opened up, so schedule a spawn if one was held back
+				if (total < options.proc && !spawnScheduled)
+				{
+					currTimeNs = clockNow();
+					ev.type = EV_SPAWN;
+					ev.timeNs = nSpawnT > currTimeNs ? nSpawnT : currTimeNs;
+					events.push(ev);
+					spawnScheduled = true;
+				}
+			}
+			else
+			{
+				// Schedule request for the time worker makes it, including overhead of sending
+				ev.type = EV_ACT;
+				ev.timeNs = msg.actNs + 1000;
+				ev.msg = msg;
+				events.push(ev);
+			}
+		}
+
+		if (total >= options.proc && running == 0)
+			break;
+
+		// Take earliest of the next scheduled event and the next fault completion
+		counterAdd(&counters->iterations, 1);
+		bool isFault = !waitQueue.empty() && (events.empty() || waitQueue.top().first <= events.top().timeNs);
+		long long nextNs = isFault ? waitQueue.top().first : events.top().timeNs;
+
+		// Move clock to event, never backwards since overhead may already have passed it
+		currTimeNs = clockNow();
+		if (nextNs > currTimeNs)
+			clockSet(nextNs);
+
+		if (isFault)
+		{
+			int slot = waitQueue.top().second;
+			waitQueue.pop();
+			completeFault(slot);
+			awaitSlot = unreported == 0 ? slot : -1;
+			unreported++;
+		}
+		else
+		{
+			ev = events.top();
+			events.pop();
+			if (ev.type == EV_SPAWN)
+			{
+				spawnScheduled = false;
+				if (total < options.proc && running < options.simul && !loadAdmit(clockNow()))
+				{
+					// Memory is overcommitted, so try again once processes have had time to finish or shrink
+					ev.timeNs = clockNow() + 10000000;
+					events.push(ev);
+					spawnScheduled = true;
+				}
+				else if (total < options.proc && running < options.simul)
+				{
+					int slot = spawnWorker();
+					awaitSlot = unreported == 0 ? slot : -1;
+					unreported++;
+					currTimeNs = clockNow();
+					nSpawnT = currTimeNs + options.interval;
+					// Schedule next spawn, or leave it until a slot opens if the simultaneous limit is reached
+					if (total < options.proc && running < options.simul)
+					{
+						ev.timeNs = nSpawnT;
+						events.push(ev);
+						spawnScheduled = true;
+					}
+				}
+			}
+			else if (ev.type == EV_ACT)
+			{
+				// Hits are granted immediately, faults wait for their completion event
+				if (handleRequest(&ev.msg))
+				{
+					awaitSlot = unreported == 0 ? slotOf(ev.msg.pid) : -1;
+					unreported++;
+				}
+			}
+			else
+			{
+				printInfo(maxProc);
+				ev.timeNs += 1000000000;
+				events.push(ev);
+			}
+		}
+
+		// Suspend or resume processes if the event changed how much memory they need
+		int resumed = loadControl();
+		if (resumed > 0)
+			awaitSlot = -1;
+		unreported += resumed;
+
+		// Send grant for request serviced by this event
+		flushGrants();
+	}
+}
+
+// Function to run simulation with requests serviced by shard threads. The main thread is left as coordinator, stepping
+// the clock once every shard has made a pass, spawning and reaping workers, and printing the tables while every shard
+// is stopped so they hold still.
+void runSharded()
+{
+	logShare();
+	shardStart(options.shards, ringSeg, options.batch);
+
+	long long lastPrintNs = clockNow();
+	long long nSpawnT = clockNow() + options.interval;
+	while (total < options.proc || running > 0)
+	{
+		shardWaitPass();
+
+		// Stop shards before ending a truncated run, so its metrics hold still while they are exported
+		if (truncated)
+		{
+			shardStop();
+			shardTotals(&totRefs, &totFaults);
+			truncateRun();
+		}
+
+		// Same as the main loop, move the clock straight to the next event if every running process is blocked on a
+		// page fault. Shards add to the clock at the same time, so move it by the difference instead of setting it.
+		long long currTimeNs = clockNow();
+		if ((running > 0 && shardWaiting() == running) || (running == 0 && total < options.proc))
+		{
+			long long nextNs = lastPrintNs + 1000000000;
+			long long doneNs = shardNextDoneNs();
+			if (doneNs < nextNs)
+				nextNs = doneNs;
+			if (total < options.proc && running < options.simul && nSpawnT < nextNs)
+				nextNs = nSpawnT;
+
+			if (nextNs > currTimeNs)
+				clockAdd(nextNs - currTimeNs);
+			else
+				incrementClock();
+		}
+		else
+			incrementClock();
+
+		reapWorkers();
+
+		// Print tables once a second of system time has passed, with totals gathered from the shards
+		currTimeNs = clockNow();
+		if (currTimeNs - lastPrintNs >= 1000000000)
+		{
+			shardLockAll();
+			shardTotals(&totRefs, &totFaults);
+			printInfo(maxProc);
+			shardUnlockAll();
+			lastPrintNs = currTimeNs;
+		}
+
+		// Spawn new worker and hand it to the shard serving its slot
+		currTimeNs = clockNow();
+		if (currTimeNs >= nSpawnT && total < options.proc && running < options.simul)
+		{
+			shardAttach(spawnWorker());
+			nSpawnT = clockNow() + options.interval;
+		}
+		counterAdd(&counters->iterations, 1);
+	}
+
+	shardStop();
+	shardTotals(&totRefs, &totFaults);
+}
+
+int main(int argc, char* argv[])
+{
+	struct timespec startTs;
+	clock_gettime(CLOCK_MONOTONIC, &startTs);
+	startWallNs = startTs.tv_sec * 1000000000LL + startTs.tv_nsec;
+
+	// Signal that will terminate program once watchdog time has passed, started after options are parsed. System calls
+	// are not restarted after it, so a wait for a worker's request ends and sees the run was truncated.
+	struct sigaction watchdogAct;
+	memset(&watchdogAct, 0, sizeof(watchdogAct));
+	watchdogAct.sa_handler = signal_handler;
+	sigemptyset(&watchdogAct.sa_mask);
+	watchdogAct.sa_flags = 0;
+	if (sigaction(SIGALRM, &watchdogAct, NULL) == -1)
+	{
+		perror("sigaction");
+		exit(1);
+	}
+
+	key_t key; // Key to access queue
+
+	// Create file to track message queue
+	system("touch msgq.txt");
+
+	// Get key for message queue
+	if ((key = ftok("msgq.txt", 1)) == -1)
+	{
+		perror("ftok");
+		exit(1);
+	}
+
+	// Create message queue
+	if ((msqid = msgget(key, PERMS | IPC_CREAT)) == -1)
+	{
+		perror("msgget in parent\n");
+		exit(1);
+	}	
+
+	printf("Message queue set up\n");
+
+	// Set default values
+	options.proc = 1;
+	options.simul = 1;
+	options.interval = 0;
+	options.policy = "lru";
+	options.record = false;
+	options.replay = false;
+	options.ring = false;
+	options.batch = DEF_PROC;
+	options.des = false;
+	options.inproc = false;
+	options.frames = DEF_FRAMES;
+	options.pages = DEF_PAGES;
+	options.pageSize = DEF_PAGE_SIZE;
+	options.verbose = LOG_REFS;
+	options.gen = DEF_GEN;
+	options.writePct = DEF_WRITE_PCT;
+	options.metrics = false;
+	options.watchdog = DEF_WATCHDOG;
+	options.tlb = "off";
+	options.swap = NULL;
+	swapConfig.on = false;
+	options.prefetch = "off";
+	options.shards = 0;
+	options.numa = NULL;
+	numaConfig.nodes = 0;
+	options.snapshot = NULL;
+	snapConfig.on = false;
+	options.load = NULL;
+	loadConfig.mode = LOAD_OFF;
+	options.shared = 0;
+	options.huge = NULL;
+	hugeConfig.order = 0;
+	prefetchConfig.mode = PF_OFF;
+	tlbConfig.mode = TLB_OFF;
+
+
+	// Values to keep track of child iterations
+	running = 0; // Number of simultaneous processes in system
+
+	const char optstr[] = "hn:s:i:fp:rRt:b:de:m:g:z:v:w:W:xa:T:P:D:F:S:N:U:L:C:H:"; // Options h, n, s, i, f, p, r, R, t, b, d, e, m, g, z, v, w, W, x, a, T, P, D, F, S, N, U, L, C, H
+	char opt;
+	
+	// Parse command line arguments with getopt
+	while ( (opt = getopt(argc, argv, optstr)) != -1)
+	{
+		switch(opt)
+		{
+			case 'h': // Help
+				// Prints usage
+				print_usage(argv[0]);
+				return EXIT_SUCCESS;
+			case 'n': // Total amount of processes
+				// Check if n's argument starts with '-'
+				if (optarg[0] == '-')
+				{
+					// Check if next character starts with other option, meaning no argument given for n and another option given
+					if (optarg[1] == 's' || optarg[1] == 'i' || optarg[1] == 'f' ||  optarg[1] == 'h')
+					{
+						// Print an error statement, print usage, and exit program
+						fprintf(stderr, "Error! Option n requires an argument.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+					else // Means argument is not another option, but is still invalid input
+					{
+						fprintf(stderr, "Error! Invalid input.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				// Loop to ensure all characters in n's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						// If non digit is found, print error statement, print usage, and exit program
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+
+				// Set proc to optarg and break
+				options.proc = atoi(optarg);
+				break;
+			
+			case 's': // Total amount of processes that can run simultaneously
+				// Checks if s's argument starts with '-'
+				if (optarg[0] == '-')
+				{
+					// Check if next character starts with other option, meaning no argument given for n and another option given
+					if (optarg[1] == 'n' || optarg[1] == 'i' || optarg[1] == 'f' ||  optarg[1] == 'h')
+					{
+						// Print an error statement, print usage, and exit program
+						fprintf(stderr, "Error! Option s requires an argument.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+					else // Means argument is not another option, but is still invalid input
+					{
+						fprintf(stderr, "Error! Invalid input.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				// Loop to ensure all characters in s's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+
+				// Set simul to optarg and break, process table is sized to fit it
+				options.simul = atoi(optarg);
+				if (options.simul < 1)
+				{
+					fprintf(stderr, "Error! Value entered for option s must be at least 1.\n");
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'i':
+				// Checks if i's argument starts with '-'
+				if (optarg[0] == '-')
+				{
+					// Checks if next character is character of other option, meaning no argument given for i and another option given
 					if (optarg[1] == 'n' || optarg[1] == 's' || optarg[1] == 'f' ||  optarg[1] == 'h')
 					{
-						// Print error statement, print usage, and exit program
-						fprintf(stderr, "Error! Option i requires an argument.\n");
+						// Print error statement, print usage, and exit program
+						fprintf(stderr, "Error! Option i requires an argument.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+					else // Means argument is not another option, but is invalid input
+					{
+						// Print error statement, print usage, and exit program
+						fprintf(stderr, "Error! Invalid input.\n");
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				// Loop to ensure all characters in i's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+
+				// Set interval to optarg, converting to ns,  and break
+				options.interval = atoll(optarg) * 1000000;
+				break;
+
+			case 'f': // Print output also to logfile if option is passed
+				logging = true;
+				// Open logfile
+				logfile = fopen("ossLog.txt", "w");
+				if (logfile == NULL)
+				{
+					fprintf(stderr, "Error! Failed to open logfile.\n");
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'p': // Page replacement policy
+				// Check if p's argument starts with '-', meaning no argument given for p and another option given
+				if (optarg[0] == '-')
+				{
+					fprintf(stderr, "Error! Option p requires an argument.\n");
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				// Ensure policy exists
+				if (findPolicy(optarg) == NULL)
+				{
+					fprintf(stderr, "Error! %s is not a valid policy.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.policy = optarg;
+				break;
+
+			case 'r': // Record trace
+				options.record = true;
+				break;
+
+			case 'R': // Replay trace
+				options.replay = true;
+				break;
+
+			case 't': // Transport between oss and workers
+				if (strcmp(optarg, "ring") == 0)
+					options.ring = true;
+				else if (strcmp(optarg, "msgq") == 0)
+					options.ring = false;
+				else
+				{
+					fprintf(stderr, "Error! %s is not a valid transport.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'd': // Discrete event mode
+				options.des = true;
+				break;
+
+			case 'x': // Export latency metrics
+				options.metrics = true;
+				break;
+
+			case 'a': // Real seconds before watchdog ends the run
+				// Loop to ensure all characters in a's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
 						print_usage(argv[0]);
 						return EXIT_FAILURE;
 					}
-					else // Means argument is not another option, but is invalid input
+				}
+				options.watchdog = atoi(optarg);
+				break;
+
+			case 'T': // TLB in front of page tables
+				if (!tlbParse(optarg, &tlbConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid TLB, entries and ways must be powers of two.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.tlb = optarg;
+				break;
+
+			case 'D': // Swap device model
+				if (!swapParse(optarg, &swapConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid swap device, expected latencyUs:bandwidthMBps[:cleanFrames].\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.swap = optarg;
+				break;
+
+			case 'F': // Prefetching on faults
+				if (!prefetchParse(optarg, &prefetchConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid prefetch, depth must be between 1 and %d.\n", optarg, MAX_PREFETCH_DEPTH);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.prefetch = optarg;
+				break;
+
+			case 'N': // Memory split into NUMA nodes
+				if (!numaParse(optarg, &numaConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid NUMA spec, expected nodes[:local|interleave|firsttouch[:migrateRefs]] with 1 to %d nodes.\n", optarg, MAX_NUMA_NODES);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.numa = optarg;
+				break;
+
+			case 'U': // Print only changes to the tables
+				if (!snapParse(optarg, &snapConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid snapshot spec, expected delta[:fullEvery] with fullEvery up to 1000000.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.snapshot = optarg;
+				break;
+
+			case 'L': // Load control
+				if (!loadParse(optarg, &loadConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid load control spec, expected ws[:window] or pff[:window[:highPct]] with window 1 to %d and highPct 1 to 100.\n", optarg, MAX_LOAD_WINDOW);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.load = optarg;
+				break;
+
+			case 'C': // Pages shared by every process
+				if (!shareParse(optarg, &options.shared))
+				{
+					fprintf(stderr, "Error! %s is not a valid amount of shared pages, must be between 1 and 1000000.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'H': // Large pages
+				if (!hugeParse(optarg, &hugeConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid large page spec, expected order[:hotRefs] with order 1 to %d and hotRefs 1 to 1000000.\n", optarg, MAX_HUGE_ORDER);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.huge = optarg;
+				break;
+
+			case 'S': // Threads servicing requests
+				// Loop to ensure all characters in S's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
 					{
-						// Print error statement, print usage, and exit program
-						fprintf(stderr, "Error! Invalid input.\n");
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
 						print_usage(argv[0]);
 						return EXIT_FAILURE;
 					}
 				}
-				// Loop to ensure all characters in i's argument are digits
+				options.shards = atoi(optarg);
+				if (options.shards < 1 || options.shards > MAX_SHARDS)
+				{
+					fprintf(stderr, "Error! Value entered for option S must be between 1 and %d.\n", MAX_SHARDS);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'P': // Kind of page table
+				if (!ptParse(optarg, &pageTableKind))
+				{
+					fprintf(stderr, "Error! %s is not a valid page table.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'e': // Engine running simulated processes
+				if (strcmp(optarg, "inproc") == 0)
+					options.inproc = true;
+				else if (strcmp(optarg, "fork") == 0)
+					options.inproc = false;
+				else
+				{
+					fprintf(stderr, "Error! %s is not a valid engine.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'b': // Most messages drained from workers per loop iteration
+				// Loop to ensure all characters in b's argument are digits
 				for (int i = 0; optarg[i] != '\0'; i++)
 				{
 					if (!isdigit(optarg[i]))
@@ -493,20 +1884,80 @@ int main(int argc, char* argv[])
 						return EXIT_FAILURE;
 					}
 				}
+				options.batch = atoi(optarg);
+				if (options.batch < 1)
+				{
+					fprintf(stderr, "Error! Value entered for option b must be at least 1.\n");
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
 
-				// Set interval to optarg, converting to ns,  and break
-				options.interval = atoll(optarg) * 1000000;
+			case 'w': // Reference generator used by workers
+				if (!refParse(optarg, &refConfig))
+				{
+					fprintf(stderr, "Error! %s is not a valid generator.\n", optarg);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.gen = optarg;
 				break;
 
-			case 'f': // Print output also to logfile if option is passed
-				logging = true;
-				// Open logfile
-				logfile = fopen("ossLog.txt", "w");
-				if (logfile == NULL)
+			case 'W': // Percent of references that are writes
+				// Loop to ensure all characters in W's argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
 				{
-					fprintf(stderr, "Error! Failed to open logfile.\n");
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				options.writePct = atoi(optarg);
+				if (options.writePct > 100)
+				{
+					fprintf(stderr, "Error! Value entered for option W cannot exceed 100.\n");
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+
+			case 'v': // Verbosity level of output
+				if (strlen(optarg) != 1 || optarg[0] < '0' + LOG_STATS || optarg[0] > '0' + LOG_REFS)
+				{
+					fprintf(stderr, "Error! Value entered for option v must be between %d and %d.\n", LOG_STATS, LOG_REFS);
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				options.verbose = optarg[0] - '0';
+				break;
+
+			case 'm': // Amount of frames in frame table
+			case 'g': // Amount of pages in each address space
+			case 'z': // Page size in bytes
+				// Loop to ensure all characters in argument are digits
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				if (atoll(optarg) < 1 || atoll(optarg) > INT_MAX)
+				{
+					fprintf(stderr, "Error! Value entered for option %c must be between 1 and %d.\n", opt, INT_MAX);
+					print_usage(argv[0]);
 					return EXIT_FAILURE;
 				}
+				if (opt == 'm')
+					options.frames = atoi(optarg);
+				else if (opt == 'g')
+					options.pages = atoi(optarg);
+				else
+					options.pageSize = atoi(optarg);
 				break;
 
 			default:
@@ -516,368 +1967,280 @@ int main(int argc, char* argv[])
 				return EXIT_FAILURE;
 		}
 	}
-			
 
-	// Set up shared memory for clock
-	shareMem();
+	// Every address of a process must fit in the address field of a request
+	if ((unsigned long long)options.pages * options.pageSize > UINT_MAX)
+	{
+		fprintf(stderr, "Error! Address space of %d pages of %u bytes is larger than %u bytes.\n", options.pages, options.pageSize, UINT_MAX);
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
 
-	// Allocate memory for process table based on total processes
-	processTable = new PCB[MAX_PROC];
-	// Initialize process table, all values set to empty
-	for (int i = 0; i < MAX_PROC; i++)
+	// Ensure recording and replaying options can be used together
+	if (options.record && options.replay)
+	{
+		fprintf(stderr, "Error! Options r and R cannot be used together.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// In-process workers only exist as events, so they always run in discrete event mode
+	if (options.inproc)
+	{
+		if (options.ring || options.replay)
+		{
+			fprintf(stderr, "Error! Engine inproc cannot be used with options t ring or R.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		options.des = true;
+	}
+	// Replay does not launch workers, so there are no worker events to schedule
+	if (options.des && options.replay)
+	{
+		fprintf(stderr, "Error! Options d and R cannot be used together.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// Optimal policy needs to know future references, so it can only run on a replayed trace
+	if (strcmp(options.policy, "opt") == 0 && !options.replay)
+	{
+		fprintf(stderr, "Error! Policy opt requires option R.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// Prefetched pages are not references, so they would throw off the future opt is given
+	if (strcmp(options.policy, "opt") == 0 && prefetchConfig.mode != PF_OFF)
+	{
+		fprintf(stderr, "Error! Policy opt cannot be used with option F.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// Shards poll the rings of their own workers and keep one LRU list each, without the rest of the paging core
+	if (options.shards > 0)
+	{
+		if (!options.ring || options.des)
+		{
+			fprintf(stderr, "Error! Option S requires transport ring, and cannot be used with option d or engine inproc.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (strcmp(options.policy, "lru") != 0 || pageTableKind != PT_FLAT || options.record || options.replay ||
+			options.metrics || tlbConfig.mode != TLB_OFF || swapConfig.on || prefetchConfig.mode != PF_OFF || numaConfig.nodes > 0)
+		{
+			fprintf(stderr, "Error! Option S only runs policy lru with flat page tables, and cannot be used with options r, R, x, T, D, F or N.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (options.frames < options.shards)
+		{
+			fprintf(stderr, "Error! Option S cannot be more than the amount of frames.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	// Suspending processes frees their frames, which a recorded trace does not capture, and shards schedule on their own
+	if (loadConfig.mode != LOAD_OFF && (options.record || options.replay || options.shards > 0))
+	{
+		fprintf(stderr, "Error! Option L cannot be used with options r, R or S.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// A hashed page table maps each frame to one process, opt's future is worked out per process, and shards keep their
+	// own page tables
+	if (options.shared > 0 && (pageTableKind == PT_HASH || strcmp(options.policy, "opt") == 0 || options.shards > 0))
 	{
-		// Set occupied to 0
-		processTable[i].occupied = 0;
-		// Set pid to -1 
-		processTable[i].pid = -1;
-		processTable[i].startSeconds = 0;
-		processTable[i].startNano = 0;
-		processTable[i].waiting = false;
-		processTable[i].waitPage = -1;
-		processTable[i].waitSec = 0;
-		processTable[i].waitNano = 0;
-		for (int j = 0; j < 32; j++)
+		fprintf(stderr, "Error! Option C cannot be used with page table hash, policy opt or option S.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	// Large pages take frames from the buddy allocator, which nodes, shared frames and shards do without, and demoting
+	// one hands the policy frames whose next use opt was never given
+	if (hugeConfig.order > 0)
+	{
+		if (numaConfig.nodes > 0 || options.shared > 0 || options.shards > 0 || strcmp(options.policy, "opt") == 0)
+		{
+			fprintf(stderr, "Error! Option H cannot be used with policy opt or options N, C or S.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if ((1 << hugeConfig.order) > options.pages || (1 << hugeConfig.order) > options.frames)
 		{
-			processTable[i].pageTable[j] = -1;
+			fprintf(stderr, "Error! Option H cannot have large pages of more pages than an address space or more frames than the frame table.\n");
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
 		}
 	}
+	// Every node needs at least one frame
+	if (numaConfig.nodes > options.frames)
+	{
+		fprintf(stderr, "Error! Option N cannot have more nodes than frames.\n");
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	policy = findPolicy(options.policy);
+
+	// Start writing output in the background, to the logfile as well if one was opened
+	logInit(logging ? logfile : NULL, options.verbose);
+
+	// Start watchdog, unless disabled
+	if (options.watchdog > 0)
+		alarm(options.watchdog);
+
+	// Create trace file if recording
+	if (options.record)
+		traceCreate(TRACE_FILE, options.pageSize, options.pages);
+
+	// Set up shared memory for clock and counters
+	shareMem();
+	shareCounters();
+
+	// Set up process table, frame table and replacement policy. The process table holds every simultaneous process,
+	// and never fewer than the default so replayed traces recorded with the defaults still fit.
+	pagerInit(options.simul > DEF_PROC ? options.simul : DEF_PROC, options.frames, options.pages, options.pageSize);
+	// Finish generator settings for in-process workers, forked workers set up their own from the same options
+	refParse(options.gen, &refConfig);
+	refConfigure(&refConfig, pageSize, pageCount, options.writePct);
+	grantSlots = arenaArray<int>(&runArena, maxProc);
+	grantPids = arenaArray<pid_t>(&runArena, maxProc);
+	statsInit(maxProc, options.metrics);
+	tlbInit(&tlbConfig, maxProc);
+	numaInit(&numaConfig);
+	hugeInit(&hugeConfig);
+	swapInit(&swapConfig, pageSize);
+	prefetchInit(&prefetchConfig);
+	snapInit(&snapConfig);
+	shareInit(options.shared);
+	loadInit(&loadConfig);
+	parkedMsg = arenaArray<msgbuffer>(&runArena, maxProc);
+	parked = arenaArray<bool>(&runArena, maxProc);
+	// Every process waits on at most one fault, so the wait queue never needs more room than the process table
+	vector<waitEntry_t> waitStore;
+	waitStore.reserve(maxProc);
+	waitQueue = waitQueue_t(greater<waitEntry_t>(), std::move(waitStore));
+	if (options.inproc)
+	{
+		inprocState = arenaArray<refState_t>(&runArena, maxProc);
+		inprocQueue = arenaArray<msgbuffer>(&runArena, maxProc);
+	}
 
-	// Allocate memory for frame table based on total frames
-	frameTable = new Frame[FRAME_NUM];
-	// Initialize frame table, all values set to empty
-	for (int i = 0; i < FRAME_NUM; i++)
+	// Set up shared memory rings if workers will use them instead of the message queue
+	useRing = options.ring;
+	if (useRing)
 	{
-		frameTable[i].occupied = false;
-		frameTable[i].dirty = false;
-		frameTable[i].ownerPid = -1;
-		frameTable[i].pageNum = -1;
-		frameTable[i].lastRefSec = 0;
-		frameTable[i].lastRefNano = 0;
+		shareRing();
+		ringSpin = ringSpinLimit();
 	}
 
 	// Variables to track last printed time
-        long long int lastPrintSec = shm_ptr[0];
-        long long int lastPrintNs = shm_ptr[1];
+	long long lastPrintNs = clockNow();
 
 	// Calculate current system time in ns
-	long long currTimeNs = (long long)shm_ptr[0] * 1000000000 + shm_ptr[1];
+	long long currTimeNs = clockNow();
 	// Calculate next time to spawn a process based on command line value given for interval
 	long long nSpawnT = currTimeNs + options.interval;
 
+	// Replay recorded trace instead of launching children, or run workers as discrete events
+	if (options.replay)
+		replayTrace(&totRefs, &totFaults);
+	else if (options.des)
+		runDiscreteEvent();
+	else if (options.shards > 0)
+		runSharded();
+
 	// Loop that will continue until total amount of processes given are launched and all running processes are terminated
-	while (total < options.proc ||  running > 0)
+	while (!options.replay && !options.des && options.shards == 0 && (total < options.proc ||  running > 0))
 	{
-		// Update system clock
-		incrementClock();
+		if (truncated)
+			truncateRun();
 
-		// Loop through and terminate any process that are finished
-		pid_t pid;
-		int status;
-		while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+		// Update system clock. If every running process is blocked on a page fault, or none are running yet, nothing
+		// can happen until the next event, so move the clock straight to it instead of stepping.
+		if ((running > 0 && (int)waitQueue.size() + parkedCount == running) || (running == 0 && total < options.proc))
 		{
-			// Find process's location in process table
-			int indx;
-			for (int i = 0; i < options.proc; i++)
-			{
-				if (processTable[i].occupied == 1 && processTable[i].pid == pid)
-				{
-					indx = i;
-					break;
-				}
-			}
-
-			// Clear process's entires in PCB and frame table
-			for (int i = 0; i < 32; i++)
-			{
-				processTable[indx].waiting = false;
-			}
-
-			for (int i = 0; i < FRAME_NUM; i++)
-			{
-				if (frameTable[i].ownerPid == pid)
-				{
-					frameTable[i].occupied = false;
-					frameTable[i].ownerPid = -1;
-					frameTable[i].pageNum = -1;
-					frameTable[i].dirty = false;
-				}
-			}
-
-			// Mark finished process as unoccupied in process table
-			processTable[indx].occupied = 0;
-			// Decrement total processes running
-			running--;
+			// Next event is the earliest fault completion, next spawn, or next table print
+			currTimeNs = clockNow();
+			long long nextNs = lastPrintNs + 1000000000;
+			if (!waitQueue.empty() && waitQueue.top().first < nextNs)
+				nextNs = waitQueue.top().first;
+			if (total < options.proc && running < options.simul && nSpawnT < nextNs)
+				nextNs = nSpawnT;
+
+			if (nextNs > currTimeNs)
+				clockSet(nextNs);
+			else
+				incrementClock();
 		}
+		else
+			incrementClock();
 
-		// Calculate time since last print for sec and ns
-		long long int printDiffSec = shm_ptr[0] - lastPrintSec;
-		long long int printDiffNs = shm_ptr[1] - lastPrintNs;
-		// Adjust ns value for subtraction resulting in negative value
-		if (printDiffNs < 0)
-		{
-			printDiffSec--;
-			printDiffNs += 1000000000;
-		}
-		// Calculate total time sincd last print in ns
-		long long int printTotDiff = printDiffSec * 1000000000 + printDiffNs;
+		// Loop through and terminate any process that are finished
+		reapWorkers();
 
-		if (printTotDiff >= 1000000000) // Determine if time of last print surpasssed .5 sec system time
+		// Print table once a second of system time has passed since the last print
+		currTimeNs = clockNow();
+		if (currTimeNs - lastPrintNs >= 1000000000)
 		{
-			// If true, print table and update time since last print in sec and ns
-			printInfo(18);
-			lastPrintSec = shm_ptr[0];
-			lastPrintNs = shm_ptr[1];
+			printInfo(maxProc);
+			lastPrintNs = currTimeNs;
 		}
 
-		currTimeNs = (long long)shm_ptr[0] * 1000000000 + shm_ptr[1];
+		currTimeNs = clockNow();
 		// Determine if a new child process can be spawned
-		// Must be greater than next spawn time, less than total process allowed (100), and less than simultanous processes allowed (18)
-		if (currTimeNs >= nSpawnT && total < options.proc  && running < options.simul)
+		// Must be greater than next spawn time, less than total process allowed, and less than simultanous processes allowed
+		if (currTimeNs >= nSpawnT && total < options.proc  && running < options.simul && loadAdmit(currTimeNs))
 		{
-			//Fork new child
-			pid_t childPid = fork();
-			if (childPid == 0) // Child process
-			{
-				// Create array of arguments to pass to exec. "./worker" is the program to execute, arg is the command line argument
-				// to be passed to "./worker", and NULL shows it is the end of the argument list
-				char* args[] = {"./worker",  NULL};
-				// Replace current process with "./worker" process and pass iteration amount as parameter
-				execvp(args[0], args);
-				// If this prints, means exec failed
-				// Prints error message and exits
-				fprintf(stderr, "Exec failed, terminating!\n");
-				exit(1);
-			}
-			else // Parent process
-			{
-				// Increment total created processes and running processes
-				total++;
-				running++;
-					
-				// Increment clock
-				incrementClock();
-
-				// Update table with new child info
-				for (int i = 0; i < 18; i++)
-				{
-					if (processTable[i].occupied == 0)
-					{
-						processTable[i].occupied = 1;
-						processTable[i].pid = childPid;
-						processTable[i].startSeconds = shm_ptr[0];
-						processTable[i].startNano = shm_ptr[1];
-						break;
-					}
-				}
-				// Calculate current time and ns and determine next spawn time
-				currTimeNs = (shm_ptr[0] * 1000000000) + shm_ptr[1];
-				nSpawnT = currTimeNs + options.interval;
+			spawnWorker();
 
-			}
+			// Calculate current time and ns and determine next spawn time
+			currTimeNs = clockNow();
+			nSpawnT = currTimeNs + options.interval;
 		}
 
-		// Check for message from worker process
-		if (msgrcv(msqid, &rcvbuf, sizeof(msgbuffer) - sizeof(long), 1, IPC_NOWAIT) > 0)
+		// Drain every ready message from workers, up to batch cap
+		int drained = 0;
+		for (; drained < options.batch && receiveRequest(&rcvbuf); drained++)
 		{
-			// Increment total reference requests
-			totRefs++;
-
-			// Find process who sent message in PCB
-			int slot = -1;
-			for (int i = 0; i < MAX_PROC; i++)
-			{
-				if (processTable[i].occupied && processTable[i].pid == rcvbuf.pid)
-				{
-					slot = i;
-					break;
-				}
-			}
-
-			// Calculate page number from address sent, ensuring it is not greater than max amount of entries
-			unsigned page = rcvbuf.address / 1024;
-			if (page >= 32)
-			{
-				fprintf(stderr, "ERROR! OSS: bad address %u. Page %u out of range.\n", rcvbuf.address, page);
-				exit(1);
-			}
-
-			// Determine if request was read or write and set to string for printing
-			string op;
-			if (rcvbuf.isWrite) op = "write";
-			else op = "read";
-
-			// Print incoming request
-			printf("oss: P%d requesting %s of address %u at time %d:%09d\n", slot, op.c_str(), rcvbuf.address, shm_ptr[0], shm_ptr[1]);
-			if (logging)
-				fprintf(logfile, "oss: P%d requesting %s of address %u at time %d:%09d\n", slot, op.c_str(), rcvbuf.address, shm_ptr[0], shm_ptr[1]);
-
-			
-			// Check page table entry 
-			int frame = processTable[slot].pageTable[page];
-			if (frame != -1) // Determine if frame found in table
-			{
-				// Add overhead
-				addOverhead();
-				// Add additional 100ns for accessing, ensuring no overflow
-				shm_ptr[1] += 100;
-				if (shm_ptr[1] >= 1000000000)
-				{
-					shm_ptr[1] -= 1000000000;
-					shm_ptr[0]++;
-				}
-
-
-				// Update last reference time in frame table
-				frameTable[frame].lastRefSec = shm_ptr[0];
-				frameTable[frame].lastRefNano = shm_ptr[1];
-
-				// Prepare and send message to worker, granting requst
-				buf.mtype = rcvbuf.pid;
-				buf.granted = true;
-				if (msgsnd(msqid, &buf, sizeof(msgbuffer) - sizeof(long), 0) == -1)
-				{
-					perror("msgsnd grant");
-					exit(1);
-				}
-				else
-				{
-					// Determine whether it is a read or write
-					if (rcvbuf.isWrite)
-					{
-						// Update dirty bit if it is a write
-						frameTable[frame].dirty = true;
-						// Print write
-						printf("oss: Address %u in frame %d, writing data to frame at time %d:%09d\n", rcvbuf.address, frame, shm_ptr[0], shm_ptr[1]);
-						if (logging)
-							fprintf(logfile, "oss: Address %u in frame %d, writing data to frame at time %d:%09d\n", rcvbuf.address, frame, shm_ptr[0], shm_ptr[1]);
-					}
-					else
-					{
-						// Print read
-						printf("oss: Address %u in frame %d, giving data to P%d at time %d:%09d\n", rcvbuf.address, frame, slot, shm_ptr[0], shm_ptr[1]);
-						if (logging)
-							fprintf(logfile, "oss: Address %u in frame %d, giving data to P%d at time %d:%09d\n", rcvbuf.address, frame, slot, shm_ptr[0], shm_ptr[1]);
-					}
-					
-				}
-			}
-			else // Page fault
-			{
-				// Increment total page faults
-				totFaults++;
-
-				// Print page fault
-				printf("oss: Address %u is not in a frame, pagefault\n", rcvbuf.address);
-				if (logging)
-					fprintf(logfile, "oss: Address %u is not in a frame, pagefault\n", rcvbuf.address);
-
-				// Mark process in PCB table as waiting
-				processTable[slot].waiting = true;
-				processTable[slot].waitPage = page;
-				processTable[slot].waitIsWrite = rcvbuf.isWrite;
-				processTable[slot].waitSec = shm_ptr[0];
-				processTable[slot].waitNano = shm_ptr[1];
-
-				// Add process to wait queue
-				waitQueue.push(slot);
-			}
+			handleRequest(&rcvbuf);
 		}
+		counterAdd(&counters->iterations, 1);
+		counterAdd(&counters->drained, drained);
 
-		// Check for any waiting processes in the queue
-		if (!waitQueue.empty())
+		// Service every waiting process whose fault latency has passed, earliest first
+		currTimeNs = clockNow();
+		while (!waitQueue.empty())
 		{
-			// Get index of next waiting process from queue 
-			int slot = waitQueue.front();
-			
-			// Compute elapsed system time since fault
-			currTimeNs = ((long long)shm_ptr[0] * 1000000000) + (long long)shm_ptr[1];
-			long long faultNs = (long long)processTable[slot].waitSec * 1000000000 + (long long)processTable[slot].waitNano;
-			// Add latency for page fault
-			long long latNs = 14 * 1000000;
-			if (processTable[slot].waitIsWrite)
-				latNs += 1000000;
-
-			// Determine if enough time has passed to service page fault
-			if (currTimeNs - faultNs >= latNs)
-			{
-				// Remove process from wait queue
-				waitQueue.pop();
-
-
-				// Load faulted page into frame using LRU replacement algorithm
-				unsigned page = processTable[slot].waitPage;
-				int frame = lruReplacement(slot);
-
-				// Update info in process table to reflect loaded page
-				processTable[slot].pageTable[page] = frame;
-				processTable[slot].waiting = false;
+			// Get index of waiting process whose fault completes first
+			int slot = waitQueue.top().second;
 
-				// Update info in frame table to reflect loaded page
-				frameTable[frame].occupied = true;
-				frameTable[frame].ownerPid = processTable[slot].pid;
-				frameTable[frame].pageNum = page;
-				frameTable[frame].dirty = processTable[slot].waitIsWrite;
-				frameTable[frame].lastRefSec = shm_ptr[0];
-				frameTable[frame].lastRefNano = shm_ptr[1];
+			// Stop once earliest remaining fault has not completed yet
+			if (waitQueue.top().first > currTimeNs)
+				break;
 
-				// Add overhead of loading page
-				addOverhead();
+			// Remove process from wait queue
+			waitQueue.pop();
 
-				// Prepare and send message to worker, granting requesst
-				buf.mtype = processTable[slot].pid;
-				buf.granted = true;
-				if (msgsnd(msqid, &buf, sizeof(buf) - sizeof(long), 0) == -1)
-				{
-					perror("msgsnd queue grant");
-					exit(1);
-				}
+			// Load page and grant request
+			completeFault(slot);
+		}
 
-				// Determine if read or write for printing
-				string opr = "read";
-				if(processTable[slot].waitIsWrite) 
-				{
-					// If write, print and add additional time (dirty bit set in LRU algorithm)
-					opr = "write";
-					printf("oss: Dirty bit of frame %d set, adding additional time to the clock\n", frame);
-					if (logging)
-						fprintf(logfile, "oss: Dirty bit of frame %d set, adding additional time to the clock\n", frame);
-					addOverhead();
-				}
+		// Suspend or resume processes if this iteration changed how much memory they need
+		loadControl();
 
-				// Determine address of process and print
-				unsigned addr = processTable[slot].waitPage * 1024;
-				printf("oss: Indicating to P%d that %s has happened to the address %u\n", slot, opr.c_str(), addr);
-				if (logging)
-					fprintf(logfile, "oss: Indicating to P%d that %s has happened to the address %u\n", slot, opr.c_str(), addr);
-			}
-		}
+		// Iteration did no work if nothing was received and no fault completed
+		if (drained == 0 && grantCount == 0)
+			counterAdd(&counters->idleSpins, 1);
 
+		// Send grants for every request serviced this iteration
+		flushGrants();
 	}
 
-	// Update time for statistics
-	currTimeNs = ((long long)shm_ptr[0] * 1000000000) + (long long)shm_ptr[1];
-
 	// Calculate and print statistics
-	double refsPerSec = ((double)totRefs * 1000000000) / currTimeNs;
-
-	double faultRate;
-	if (totRefs > 0)
-		faultRate = (100.0 * totFaults) / totRefs;
-	else faultRate = 0.0;
+	printStats(totRefs, totFaults);
 
-	printf("\n----Simulation Statistics----\n");
-	if (logging) fprintf(logfile, "\n----Simulation Statistics----\n");
-	printf("Total memory references: %d\n", totRefs);
-	if (logging) fprintf(logfile, "Total memory references: %d\n", totRefs);
-	printf("Total page faults: %d\n", totFaults);
-	if (logging) fprintf(logfile, "Total page faults: %d\n", totFaults);
-	printf("Fault rate: %.2f%%\n", faultRate);
-	if (logging) fprintf(logfile, "Fault rate: %.2f%%\n", faultRate);
-	printf("References per sec of system time: %.2f\n", refsPerSec);
-	if (logging) fprintf(logfile, "References per sec of system time: %.2f\n", refsPerSec);
+	traceClose();
 
 	// Detach from shared memory and remove it
-	if(shmdt(shm_ptr) == -1)
+	if(shmdt(simClock) == -1)
 	{
 		perror("shmdt failed");
 		exit(1);
@@ -894,6 +2257,12 @@ int main(int argc, char* argv[])
 		perror("msgctl failed");
 		exit(1);
 	}
+	removeRing();
+	removeCounters();
+
+	// Free tables of the run
+	pagerFree();
+	arenaRelease(&runArena);
 
 	return 0;
 
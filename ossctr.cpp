@@ -0,0 +1,140 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Program that reads the counters of a running oss from shared memory without stopping it. Run from the
+// same directory as oss. Every interval it prints each counter and how much it grew since the last print, with cycle
+// counts converted to milliseconds, until oss exits.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "counters.h"
+
+#define DEF_INTERVAL_MS 1000 // Default time between prints
+
+ossCounters_t* counters;
+
+void print_usage(const char * app)
+{
+	fprintf(stdout, "usage: %s [-h] [-i intervalInMs]\n", app);
+	fprintf(stdout, "      interval is the time between prints of the counters of a running oss (default %d)\n", DEF_INTERVAL_MS);
+}
+
+// Function to read real time in ns
+long long wallNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Function to attach read-only to counters segment of a running oss
+void attachCounters()
+{
+	key_t ctr_key = ftok("msgq.txt", CTR_PROJ);
+	int ctr_id = ctr_key == -1 ? -1 : shmget(ctr_key, sizeof(ossCounters_t), 0);
+	if (ctr_id == -1)
+	{
+		fprintf(stderr, "Error! No running oss found, start it from this directory first.\n");
+		exit(1);
+	}
+	counters = (ossCounters_t*)shmat(ctr_id, 0, SHM_RDONLY);
+	if (counters == (ossCounters_t*)-1)
+	{
+		perror("shmat counters");
+		exit(1);
+	}
+	if (counters->magic != CTR_MAGIC)
+	{
+		fprintf(stderr, "Error! Counters segment was not set up by this version of oss.\n");
+		exit(1);
+	}
+}
+
+// Function to print one counter and its growth since the last print
+void printCounter(const char* name, unsigned long long value, unsigned long long* last)
+{
+	printf("  %-16s %16llu %+14lld\n", name, value, (long long)(value - *last));
+	*last = value;
+}
+
+// Function to print a cycle counter as ms and its growth since the last print
+void printCycles(const char* name, unsigned long long value, unsigned long long* last, double cyclesPerMs)
+{
+	printf("  %-16s %13.3f ms %+11.3f ms\n", name, value / cyclesPerMs, (value - *last) / cyclesPerMs);
+	*last = value;
+}
+
+int main(int argc, char* argv[])
+{
+	long long interval = DEF_INTERVAL_MS;
+	char opt;
+	while ((opt = getopt(argc, argv, "hi:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'h':
+				print_usage(argv[0]);
+				return EXIT_SUCCESS;
+			case 'i':
+				for (int i = 0; optarg[i] != '\0'; i++)
+				{
+					if (!isdigit(optarg[i]))
+					{
+						fprintf(stderr, "Error! %s is not a valid number.\n", optarg);
+						print_usage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				}
+				interval = atoll(optarg);
+				if (interval < 1)
+				{
+					fprintf(stderr, "Error! Value entered for option i must be at least 1.\n");
+					print_usage(argv[0]);
+					return EXIT_FAILURE;
+				}
+				break;
+			default:
+				print_usage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	attachCounters();
+	pid_t pid = counters->pid;
+	unsigned long long last[11] = { 0 };
+	struct timespec wait = { (time_t)(interval / 1000), (long)(interval % 1000) * 1000000 };
+
+	// Print until oss exits, its segment stays attached and readable until then
+	while (kill(pid, 0) == 0)
+	{
+		// Rate of timestamp counter, measured from the pair of readings oss took at startup
+		long long elapsedNs = wallNs() - counters->startWallNs;
+		double cyclesPerMs = 1.0;
+		if (elapsedNs > 0)
+			cyclesPerMs = (double)(counterCycles() - counters->startTsc) * 1000000.0 / elapsedNs;
+
+		printf("oss %d after %.3f s\n", pid, elapsedNs / 1e9);
+		printCounter("iterations", counters->iterations.load(), &last[0]);
+		printCounter("drained", counters->drained.load(), &last[1]);
+		printCounter("idleSpins", counters->idleSpins.load(), &last[2]);
+		printCounter("rcvEmpty", counters->rcvEmpty.load(), &last[3]);
+		printCounter("victims", counters->victims.load(), &last[4]);
+		printCounter("scanFrames", counters->scanFrames.load(), &last[5]);
+		printCycles("replaceTime", counters->replaceCycles.load(), &last[6], cyclesPerMs);
+		printCounter("printCalls", counters->printCalls.load(), &last[7]);
+		printCycles("printTime", counters->printCycles.load(), &last[8], cyclesPerMs);
+		printCounter("reapCalls", counters->reapCalls.load(), &last[9]);
+		printCycles("reapTime", counters->reapCycles.load(), &last[10], cyclesPerMs);
+		fflush(stdout);
+		nanosleep(&wait, NULL);
+	}
+
+	shmdt(counters);
+	return EXIT_SUCCESS;
+}
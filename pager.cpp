@@ -0,0 +1,911 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Paging core used by oss. Owns the process table and frame table along with the stacks of free frames and
+// free PCB slots, all sized at startup and allocated from one arena, and a map from pid to PCB slot. Services page hits and page faults for a process's PCB slot, asking the selected replacement policy for a victim
+// only once the free stack is empty. Every process keeps a list of the frames it owns, so it can release them all when
+// it terminates without looking at the rest of the frame table. Frames holding shared pages are mapped by every process
+// referencing them and belong to none of them. With large pages, free frames come from the buddy allocator instead of
+// the free stack, and a large page is known to the policy by the first frame of its run.
+
+#include <stdio.h>
+#include <time.h>
+#include <unordered_map>
+#include "pager.h"
+#include "log.h"
+#include "counters.h"
+#include "tlb.h"
+#include "pagetable.h"
+#include "swap.h"
+#include "prefetch.h"
+#include "numa.h"
+#include "share.h"
+#include "huge.h"
+
+// Global tables
+PCB* processTable; // Process control block table to track child processes
+frameTable_t frameTable; // Frame table of frameNum frames
+const policy_t* policy; // Page replacement policy in use
+arena_t pagerArena = { NULL, 0 }; // Arena every table of the pager is allocated from, released by pagerFree
+
+int maxProc = DEF_PROC; // Amount of PCB slots in process table
+int frameNum = DEF_FRAMES; // Amount of frames in frame table
+int pageCount = DEF_PAGES; // Amount of pages in each process's page table
+unsigned pageSize = DEF_PAGE_SIZE; // Size of a page in bytes
+
+unsigned long long* frameChangedRanges = NULL; // Bit for every range of 64 frames changed since last print, NULL if unused
+
+int* freeStack; // Stack of free frame indices
+int freeTop = 0; // Amount of frames currently on free stack
+
+int* slotStack; // Stack of free PCB slots
+int slotTop = 0; // Amount of slots currently on slot stack
+std::unordered_map<pid_t, int, std::hash<pid_t>, std::equal_to<pid_t>, poolAllocator<std::pair<const pid_t, int> > >
+	pidSlots; // PCB slot of every process in process table
+
+pid_t lastVictimPid = -1; // PID whose page was evicted by last page fault, -1 if a free frame was used
+int lastVictimPage = -1; // Page evicted by last page fault, -1 if a free frame was used
+
+long long replaceNs = 0; // Total real time spent choosing and loading frames for page faults
+
+// Function to allocate and initialize process table, frame table and free stacks for the given sizes, then reset the
+// policy
+void pagerInit(int procs, int frames, int pages, unsigned size)
+{
+	maxProc = procs;
+	frameNum = frames;
+	pageCount = pages;
+	pageSize = size;
+
+	// Allocate memory for process table based on total processes
+	processTable = arenaArray<PCB>(&pagerArena, maxProc);
+	// Initialize process table, all values set to empty
+	for (int i = 0; i < maxProc; i++)
+	{
+		// Set occupied to 0
+		processTable[i].occupied = 0;
+		// Set pid to -1
+		processTable[i].pid = -1;
+		processTable[i].startSeconds = 0;
+		processTable[i].startNano = 0;
+		processTable[i].waiting = false;
+		processTable[i].waitPage = -1;
+		processTable[i].waitSec = 0;
+		processTable[i].waitNano = 0;
+		processTable[i].residentHead = -1;
+		processTable[i].residentCount = 0;
+		processTable[i].lastFaultPage = -1;
+		processTable[i].faultStride = 0;
+		processTable[i].strideRun = 0;
+	}
+
+	// Allocate free slot stack and push every slot, highest first so slot 0 is used first
+	slotStack = arenaArray<int>(&pagerArena, maxProc);
+	for (int i = maxProc - 1; i >= 0; i--)
+	{
+		slotStack[slotTop++] = i;
+	}
+	pidSlots.clear();
+	pidSlots.reserve(maxProc);
+
+	// Allocate memory for frame table based on total frames, with every flag bitset cleared since arena memory is zeroed
+	int words = (frameNum + 63) / 64;
+	frameTable.occupied = arenaArray<unsigned long long>(&pagerArena, words);
+	frameTable.dirty = arenaArray<unsigned long long>(&pagerArena, words);
+	frameTable.refBit = arenaArray<unsigned long long>(&pagerArena, words);
+	frameTable.prefetched = arenaArray<unsigned long long>(&pagerArena, words);
+	frameTable.lastRefNs = arenaArray<long long>(&pagerArena, frameNum);
+	frameTable.ownerPid = arenaArray<pid_t>(&pagerArena, frameNum);
+	frameTable.ownerSlot = arenaArray<int>(&pagerArena, frameNum);
+	frameTable.pageNum = arenaArray<int>(&pagerArena, frameNum);
+	frameTable.lruPrev = arenaArray<int>(&pagerArena, frameNum);
+	frameTable.lruNext = arenaArray<int>(&pagerArena, frameNum);
+	frameTable.ownPrev = arenaArray<int>(&pagerArena, frameNum);
+	frameTable.ownNext = arenaArray<int>(&pagerArena, frameNum);
+	// Initialize frame table, all values set to empty
+	for (int i = 0; i < frameNum; i++)
+	{
+		frameTable.ownerPid[i] = -1;
+		frameTable.ownerSlot[i] = -1;
+		frameTable.pageNum[i] = -1;
+		frameTable.lastRefNs[i] = 0;
+		frameTable.lruPrev[i] = -1;
+		frameTable.lruNext[i] = -1;
+		frameTable.ownPrev[i] = -1;
+		frameTable.ownNext[i] = -1;
+	}
+
+	// Allocate free stack and push every frame, highest first so frame 0 is used first
+	freeStack = arenaArray<int>(&pagerArena, frameNum);
+	for (int i = frameNum - 1; i >= 0; i--)
+	{
+		freeStack[freeTop++] = i;
+	}
+
+	// Set up empty page tables now that the frame table exists for hashed tables to chain through
+	ptInit();
+	policy->init();
+}
+
+// Function to free every table allocated by pagerInit, so the pager can be set up again with other sizes
+void pagerFree()
+{
+	ptFree();
+	arenaRelease(&pagerArena);
+	pidSlots.clear();
+	slotTop = 0;
+	freeTop = 0;
+}
+
+// Function to take a free PCB slot and mark it occupied, returns -1 if every slot is in use
+int slotAlloc()
+{
+	if (slotTop == 0)
+		return -1;
+	int slot = slotStack[--slotTop];
+	processTable[slot].occupied = 1;
+	return slot;
+}
+
+// Function to give process in PCB slot its pid, so requests and exits from that pid can find the slot
+void slotBind(int slot, pid_t pid)
+{
+	processTable[slot].pid = pid;
+	pidSlots[pid] = slot;
+}
+
+// Function to find PCB slot of process with pid, returns -1 if no process in table has that pid
+int slotOf(pid_t pid)
+{
+	auto it = pidSlots.find(pid);
+	if (it == pidSlots.end())
+		return -1;
+	return it->second;
+}
+
+// Function to mark PCB slot unoccupied and return it to the free slot stack
+void slotFree(int slot)
+{
+	pidSlots.erase(processTable[slot].pid);
+	processTable[slot].occupied = 0;
+	processTable[slot].pid = -1;
+	slotStack[slotTop++] = slot;
+}
+
+// Function to reset a recency list to empty
+void listInit(frameList_t* list)
+{
+	list->head = -1;
+	list->tail = -1;
+	list->size = 0;
+}
+
+// Function to remove frame from recency list, keeping neighbors linked
+void listUnlink(frameList_t* list, int frame)
+{
+	int prev = frameTable.lruPrev[frame];
+	int next = frameTable.lruNext[frame];
+
+	// Link previous frame to next frame, or move head if frame was most recent
+	if (prev != -1)
+		frameTable.lruNext[prev] = next;
+	else
+		list->head = next;
+
+	// Link next frame to previous frame, or move tail if frame was least recent
+	if (next != -1)
+		frameTable.lruPrev[next] = prev;
+	else
+		list->tail = prev;
+
+	frameTable.lruPrev[frame] = -1;
+	frameTable.lruNext[frame] = -1;
+	list->size--;
+}
+
+// Function to add frame to front of recency list as most recently used
+void listPushFront(frameList_t* list, int frame)
+{
+	frameTable.lruPrev[frame] = -1;
+	frameTable.lruNext[frame] = list->head;
+	if (list->head != -1)
+		frameTable.lruPrev[list->head] = frame;
+	list->head = frame;
+	// If list was empty, frame is also least recently used
+	if (list->tail == -1)
+		list->tail = frame;
+	list->size++;
+}
+
+// Function to put frame to in the place of frame from in recency list, leaving from unlinked
+void listReplace(frameList_t* list, int from, int to)
+{
+	int prev = frameTable.lruPrev[from];
+	int next = frameTable.lruNext[from];
+	frameTable.lruPrev[to] = prev;
+	frameTable.lruNext[to] = next;
+	if (prev != -1)
+		frameTable.lruNext[prev] = to;
+	else
+		list->head = to;
+	if (next != -1)
+		frameTable.lruPrev[next] = to;
+	else
+		list->tail = to;
+	frameTable.lruPrev[from] = -1;
+	frameTable.lruNext[from] = -1;
+}
+
+// Function to count set bits among the first n bits of a bitset
+int bitCount(const unsigned long long* set, int n)
+{
+	int count = 0;
+	for (int w = 0; w < n / 64; w++)
+	{
+		count += __builtin_popcountll(set[w]);
+	}
+	if (n % 64)
+		count += __builtin_popcountll(set[n / 64] & ((1ULL << (n % 64)) - 1));
+	return count;
+}
+
+// Function to add frame to front of resident list of process in slot
+void residentPush(int slot, int frame)
+{
+	int head = processTable[slot].residentHead;
+	frameTable.ownPrev[frame] = -1;
+	frameTable.ownNext[frame] = head;
+	if (head != -1)
+		frameTable.ownPrev[head] = frame;
+	processTable[slot].residentHead = frame;
+	processTable[slot].residentCount++;
+}
+
+// Function to remove frame from resident list of process in slot, keeping neighbors linked
+void residentUnlink(int slot, int frame)
+{
+	int prev = frameTable.ownPrev[frame];
+	int next = frameTable.ownNext[frame];
+	if (prev != -1)
+		frameTable.ownNext[prev] = next;
+	else
+		processTable[slot].residentHead = next;
+	if (next != -1)
+		frameTable.ownPrev[next] = prev;
+	frameTable.ownPrev[frame] = -1;
+	frameTable.ownNext[frame] = -1;
+	processTable[slot].residentCount--;
+}
+
+// Function to take a free frame for page of process in slot, from the node picked by the placement policy if memory
+// is split into nodes, or from the buddy allocator if large pages are used. There must be a free frame.
+static int takeFree(int slot, unsigned page)
+{
+	freeTop--;
+	if (numaEnabled())
+		return numaTake(slot, page);
+	if (hugeEnabled())
+		return buddyTake(0);
+	return freeStack[freeTop];
+}
+
+// Function to return a frame to the free stack, the free stack of its node, or the buddy allocator
+static void giveFree(int frame)
+{
+	if (numaEnabled())
+		numaGive(frame);
+	else if (hugeEnabled())
+		buddyGive(frame);
+	else
+		freeStack[freeTop] = frame;
+	freeTop++;
+}
+
+// Function to find first page of the region of a large page holding page
+static inline unsigned regionBase(unsigned page)
+{
+	return page & ~(unsigned)(hugePages() - 1);
+}
+
+// Function to find page the TLB entry of the large page holding page is kept under, its region number tagged so it can
+// not be taken for a base page while still spreading large pages over every set
+static inline unsigned largeKey(unsigned page)
+{
+	return HUGE_TLB_KEY | (page >> hugeOrder());
+}
+
+// Function to put translation of page of process in slot to frame in the TLB, as the one entry of its whole large page
+// if it is mapped by one
+static void tlbMap(int slot, unsigned page, int frame)
+{
+	int run = hugeEnabled() ? hugeFrame(slot, page) : -1;
+	if (run == -1)
+		tlbInsert(slot, page, frame);
+	else
+		tlbInsert(slot, largeKey(page), run);
+}
+
+// Function to clear the fields of a frame whose page has been unmapped
+static void clearFrame(int frame)
+{
+	frameChanged(frame);
+	bitAssign(frameTable.occupied, frame, false);
+	bitAssign(frameTable.dirty, frame, false);
+	bitAssign(frameTable.refBit, frame, false);
+	bitAssign(frameTable.prefetched, frame, false);
+	frameTable.ownerPid[frame] = -1;
+	frameTable.ownerSlot[frame] = -1;
+	frameTable.pageNum[frame] = -1;
+}
+
+// Function to copy page of its owner in occupied frame to free frame target, already taken from the free frames, and
+// clear frame without freeing it. The policy keeps the page in the same place in its order, and the TLB entry is dropped
+// so the next lookup finds the new frame.
+static void movePage(int frame, int target)
+{
+	int slot = frameTable.ownerSlot[frame];
+	unsigned page = frameTable.pageNum[frame];
+	frameChanged(frame);
+	frameChanged(target);
+	bitAssign(frameTable.occupied, target, true);
+	bitAssign(frameTable.dirty, target, bitTest(frameTable.dirty, frame));
+	bitAssign(frameTable.refBit, target, bitTest(frameTable.refBit, frame));
+	bitAssign(frameTable.prefetched, target, bitTest(frameTable.prefetched, frame));
+	frameTable.lastRefNs[target] = frameTable.lastRefNs[frame];
+	frameTable.ownerPid[target] = frameTable.ownerPid[frame];
+	frameTable.ownerSlot[target] = slot;
+	frameTable.pageNum[target] = page;
+	residentUnlink(slot, frame);
+	residentPush(slot, target);
+	ptClear(slot, page);
+	ptSet(slot, page, target);
+	tlbInvalidate(slot, page);
+	policy->moved(frame, target);
+	clearFrame(frame);
+}
+
+// Function to copy page of process in slot from frame to a free frame on the node the process runs on, returns frame
+// now holding the page, which is the same frame if that node has none free
+static int migratePage(int slot, int frame)
+{
+	int target = numaTakeNode(numaCpuNode(slot));
+	if (target == -1)
+		return frame;
+	freeTop--;
+
+	unsigned page = frameTable.pageNum[frame];
+	movePage(frame, target);
+	// Return old frame to its node
+	giveFree(frame);
+
+	clockAdd(NUMA_MIGRATE_NS);
+	numaMigrations++;
+	logPrintf(LOG_REFS, "oss: Migrating p%d page %u from frame %d to frame %d on node %d\n", slot, page, frame, target,
+		numaFrameNode(target));
+	return target;
+}
+
+// Function to find frame holding page of process in slot, -1 if it is not resident. With a TLB, the translation is
+// looked up there first and the time of the TLB hit or of the page table walk is added to the clock.
+int pageLookup(int slot, unsigned page)
+{
+	if (!tlbEnabled())
+		return ptGet(slot, page);
+
+	// Page of a large page is found at its offset from the first frame of the run in the large page's entry
+	unsigned key = page;
+	int offset = 0;
+	if (hugeEnabled() && hugeFrame(slot, page) != -1)
+	{
+		key = largeKey(page);
+		offset = page - regionBase(page);
+	}
+	int frame = tlbLookup(slot, key);
+	if (frame != -1)
+	{
+		clockAdd(TLB_HIT_NS);
+		return frame + offset;
+	}
+	clockAdd(TLB_WALK_NS);
+	frame = ptGet(slot, page);
+	if (frame != -1)
+		tlbInsert(slot, key, frame - offset);
+	return frame;
+}
+
+// Function to demote the large page holding victim back to base pages, once the policy has picked victim to be evicted.
+// The other frames of its run keep their pages, and the ones the policy does not yet hold join it as if just loaded.
+static void demoteLarge(int victim)
+{
+	int run = victim & ~(hugePages() - 1);
+	int slot = frameTable.ownerSlot[run];
+	unsigned base = frameTable.pageNum[run];
+	hugeUnmap(slot, base);
+	tlbInvalidate(slot, largeKey(base));
+	// Policy holds the first frame already, unless it is the victim
+	for (int i = 1; i < hugePages(); i++)
+	{
+		if (run + i != victim)
+			policy->loaded(run + i);
+	}
+	hugeDemotions++;
+	logPrintf(LOG_REFS, "oss: Demoting large page of p%d pages %u-%u in frames %d-%d\n", slot, base, base + hugePages() - 1,
+		run, run + hugePages() - 1);
+}
+
+// Function to evict the frame chosen by the replacement policy, returning its owner's pid and page in victimPid and
+// victimPage. Returns the frame, which is unmapped but still holds the victim's fields for the caller to overwrite.
+static int evictFrame(pid_t* victimPid, int* victimPage)
+{
+	// Ask replacement policy which occupied frame to clear
+	int frame = policy->victim();
+	counterAdd(&counters->victims, 1);
+
+	// Remove page from page table and resident list of process who the frame belonged to
+	if (hugeIsLarge(frame))
+		demoteLarge(frame);
+	*victimPid = frameTable.ownerPid[frame];
+	*victimPage = frameTable.pageNum[frame];
+	int owner = frameTable.ownerSlot[frame];
+	// Write back victim's page if it was modified, without delaying the process being granted the frame
+	if (swapEnabled() && bitTest(frameTable.dirty, frame))
+		swapWrite(clockNow());
+	if (bitTest(frameTable.prefetched, frame))
+		prefetchWasted++;
+	// Shared page is cleared from every process mapping it
+	if (frameTable.ownerPid[frame] == SHARED_PID)
+		shareUnmapAll(frameTable.pageNum[frame]);
+	else
+	{
+		ptClear(owner, frameTable.pageNum[frame]);
+		tlbInvalidate(owner, frameTable.pageNum[frame]);
+		residentUnlink(owner, frame);
+	}
+	return frame;
+}
+
+// Function to load page of process in slot into a frame. Takes a free frame if one exists, otherwise evicts the frame
+// chosen by the replacement policy, returning its owner's pid and page in victimPid and victimPage, or -1 if a free
+// frame was used. Prefetched pages are tagged and left unreferenced, so a policy can take them back first. A shared page
+// read by a process that has not written it is loaded as the copy every process maps, and a write to one loads the
+// process's own copy.
+static int loadPage(int slot, unsigned page, bool isWrite, bool prefetched, pid_t* victimPid, int* victimPage)
+{
+	bool shared = shareIsShared(slot, page);
+	if (shared && isWrite)
+	{
+		sharePrivate(slot, page);
+		shared = false;
+	}
+	policy->miss(pageKey(shared ? SHARED_PID : processTable[slot].pid, page));
+
+	// Attempt to take free frame from top of free stack
+	int frame = -1;
+	*victimPid = -1;
+	*victimPage = -1;
+	if (freeTop > 0)
+		frame = takeFree(slot, page);
+
+	if (frame < 0) // If true, no free frame found
+		frame = evictFrame(victimPid, victimPage);
+
+	// Update frame table and page table to add new frame for process
+	frameChanged(frame);
+	bitAssign(frameTable.occupied, frame, true);
+	frameTable.ownerPid[frame] = shared ? SHARED_PID : processTable[slot].pid;
+	frameTable.ownerSlot[frame] = shared ? -1 : slot;
+	if (shared)
+		shareLoaded(slot, page, frame);
+	else
+		residentPush(slot, frame);
+	frameTable.pageNum[frame] = page;
+	ptSet(slot, page, frame);
+	// Set dirty bit based on whether request was read or write
+	bitAssign(frameTable.dirty, frame, isWrite);
+	bitAssign(frameTable.refBit, frame, !prefetched);
+	bitAssign(frameTable.prefetched, frame, prefetched);
+	// Update time last referenced in frame table
+	frameTable.lastRefNs[frame] = clockNow();
+	policy->loaded(frame);
+	return frame;
+}
+
+// Function to load the whole region holding page of process in slot into a free run as a large page, on a fault on a
+// region promoted before. The rest of the region is read along with the faulted page. Returns frame holding page, or -1
+// if a page of the region is still resident or no free run is left, for the page to be loaded on its own.
+static int loadLarge(int slot, unsigned page, bool isWrite)
+{
+	int pages = hugePages();
+	unsigned base = regionBase(page);
+	for (int i = 0; i < pages; i++)
+	{
+		if (ptGet(slot, base + i) != -1)
+			return -1;
+	}
+	int run = buddyTake(hugeOrder());
+	if (run == -1)
+	{
+		hugeNoRun++;
+		return -1;
+	}
+	freeTop -= pages;
+	policy->miss(pageKey(processTable[slot].pid, page));
+
+	long long nowNs = clockNow();
+	for (int i = 0; i < pages; i++)
+	{
+		int frame = run + i;
+		bool faulted = base + i == page;
+		frameChanged(frame);
+		bitAssign(frameTable.occupied, frame, true);
+		frameTable.ownerPid[frame] = processTable[slot].pid;
+		frameTable.ownerSlot[frame] = slot;
+		frameTable.pageNum[frame] = base + i;
+		residentPush(slot, frame);
+		ptSet(slot, base + i, frame);
+		bitAssign(frameTable.dirty, frame, faulted && isWrite);
+		bitAssign(frameTable.refBit, frame, faulted);
+		bitAssign(frameTable.prefetched, frame, false);
+		frameTable.lastRefNs[frame] = nowNs;
+		if (i > 0 && swapEnabled())
+			swapPrefetch(nowNs);
+	}
+	hugeMap(slot, base, run);
+	policy->loaded(run);
+	hugeFaults++;
+	logPrintf(LOG_REFS, "oss: Loading p%d pages %u-%u as a large page into frames %d-%d\n", slot, base, base + pages - 1,
+		run, run + pages - 1);
+	return run + (page - base);
+}
+
+// Function to pick the aligned run region of process in slot starting at page base is compacted into, which is the run
+// already holding the most of its pages among those holding no large page. Returns first frame of the run, -1 if every
+// run holding a page of the region also holds a large page.
+static int compactTarget(int slot, unsigned base)
+{
+	int pages = hugePages();
+	int best = -1, bestCount = 0;
+	for (int i = 0; i < pages; i++)
+	{
+		int run = ptGet(slot, base + i) & ~(pages - 1);
+		int count = 0;
+		for (int f = run; f < run + pages; f++)
+		{
+			if (hugeIsLarge(f))
+			{
+				count = -1;
+				break;
+			}
+			if (frameTable.ownerSlot[f] == slot && frameTable.pageNum[f] - (int)base >= 0 && frameTable.pageNum[f] - (int)base < pages)
+				count++;
+		}
+		if (count > bestCount)
+		{
+			best = run;
+			bestCount = count;
+		}
+	}
+	return best;
+}
+
+// Function to promote region holding page of process in slot in frame to a large page, once every page of the region is
+// resident. The pages are copied into a free run if one is left. Otherwise the run already holding the most of them is
+// compacted, moving every other page in it to a free frame, with the policy's victim evicted first if none is free. The
+// run takes the place in the policy's order of the most recently used page of the region. Returns frame holding page
+// afterwards, which is frame if the region was not promoted.
+static int promoteRegion(int slot, unsigned page, int frame)
+{
+	int pages = hugePages();
+	unsigned base = regionBase(page);
+	for (int i = 0; i < pages; i++)
+	{
+		if (ptGet(slot, base + i) == -1)
+			return frame;
+	}
+	int run = buddyTake(hugeOrder());
+	if (run != -1)
+		freeTop -= pages;
+	else
+	{
+		// Make room to move pages out of the run, which may evict a page of the region itself
+		if (freeTop == 0)
+		{
+			pid_t victimPid;
+			int victimPage;
+			int scratch = evictFrame(&victimPid, &victimPage);
+			clearFrame(scratch);
+			giveFree(scratch);
+			logPrintf(LOG_REFS, "oss: Clearing frame %d to compact frames for p%d\n", scratch, slot);
+			// Region stays as it is if the victim was one of its pages, even the one just referenced in frame
+			for (int i = 0; i < pages; i++)
+			{
+				if (ptGet(slot, base + i) == -1)
+					return frame;
+			}
+		}
+		run = compactTarget(slot, base);
+		if (run == -1)
+		{
+			hugeNoRun++;
+			return frame;
+		}
+	}
+
+	// Put each page of the region at its place in the run, moving out whatever holds that place first
+	int copies = 0;
+	for (int i = 0; i < pages; i++)
+	{
+		int from = ptGet(slot, base + i);
+		int to = run + i;
+		if (from == to)
+			continue;
+		if (bitTest(frameTable.occupied, to))
+		{
+			movePage(to, takeFree(slot, 0));
+			copies++;
+		}
+		else if (buddyClaim(to))
+			freeTop--;
+		movePage(from, to);
+		giveFree(from);
+		copies++;
+	}
+	hugeMap(slot, base, run);
+
+	// Policy keeps only the first frame, in the place of the most recently used page
+	int recent = run;
+	for (int i = 1; i < pages; i++)
+	{
+		if (frameTable.lastRefNs[run + i] > frameTable.lastRefNs[recent])
+			recent = run + i;
+	}
+	for (int i = 0; i < pages; i++)
+	{
+		if (run + i != recent)
+			policy->freed(run + i);
+	}
+	if (recent != run)
+		policy->moved(recent, run);
+
+	clockAdd((long long)HUGE_COPY_NS * copies);
+	hugeCopies += copies;
+	hugePromotions++;
+	logPrintf(LOG_REFS, "oss: Promoting p%d pages %u-%u to a large page in frames %d-%d\n", slot, base, base + pages - 1,
+		run, run + pages - 1);
+	return run + (page - base);
+}
+
+// Function to map resident shared page into page table and TLB of process in slot, returns its frame
+static int mapShared(int slot, unsigned page)
+{
+	int frame = shareFrame(page);
+	shareMap(slot, page);
+	ptSet(slot, page, frame);
+	tlbInsert(slot, page, frame);
+	return frame;
+}
+
+// Function to map shared page another process has resident for process in slot, so referencing it needs no fault.
+// Returns its frame, or -1 if the page is not shared by the process or not resident.
+int pageShared(int slot, unsigned page)
+{
+	if (!shareIsShared(slot, page) || shareFrame(page) == -1)
+		return -1;
+	shareMaps++;
+	return mapShared(slot, page);
+}
+
+// Function to give process in slot its own copy of the shared page in frame on its first write to it, returns frame
+// holding the copy. The last process mapping a shared page takes its frame over instead of copying it.
+static int splitShared(int slot, int frame)
+{
+	unsigned page = frameTable.pageNum[frame];
+	ptClear(slot, page);
+	tlbInvalidate(slot, page);
+	sharePrivate(slot, page);
+	shareSplits++;
+	if (shareUnmap(slot, page) == 0)
+	{
+		frameChanged(frame);
+		frameTable.ownerPid[frame] = processTable[slot].pid;
+		frameTable.ownerSlot[frame] = slot;
+		residentPush(slot, frame);
+		ptSet(slot, page, frame);
+		tlbInsert(slot, page, frame);
+		return frame;
+	}
+
+	// Copy page into a frame of its own, which may evict the shared frame itself now that this process no longer maps it
+	pid_t victimPid;
+	int victimPage;
+	int copy = loadPage(slot, page, true, false, &victimPid, &victimPage);
+	tlbInsert(slot, page, copy);
+	clockAdd(SHARE_COPY_NS);
+	logPrintf(LOG_REFS, "oss: Copying shared page %u from frame %d to frame %d for p%d\n", page, frame, copy, slot);
+	return copy;
+}
+
+// Function to update frame table for a reference to a page that is already resident, returns frame holding the page
+// afterwards, which only differs from frame if the page was migrated to its process's node or its region was promoted
+int pageHit(int slot, int frame, bool isWrite)
+{
+	// First write to a shared page gives the process its own copy, which the write then goes to
+	if (isWrite && frameTable.ownerPid[frame] == SHARED_PID)
+		return pageHit(slot, splitShared(slot, frame), isWrite);
+
+	// Update last reference time in frame table
+	frameChanged(frame);
+	frameTable.lastRefNs[frame] = clockNow();
+	bitAssign(frameTable.refBit, frame, true);
+	// First reference to a prefetched page shows prefetching it was useful
+	if (bitTest(frameTable.prefetched, frame))
+	{
+		bitAssign(frameTable.prefetched, frame, false);
+		prefetchUsed++;
+	}
+	// Update dirty bit if it is a write
+	if (isWrite)
+		bitAssign(frameTable.dirty, frame, true);
+
+	// A large page is known to the policy by the first frame of its run, which is referenced along with any of its pages
+	if (hugeIsLarge(frame))
+	{
+		int run = frame & ~(hugePages() - 1);
+		bitAssign(frameTable.refBit, run, true);
+		policy->hit(run);
+		return frame;
+	}
+	policy->hit(frame);
+
+	// Promote region once it has been referenced often enough while mapped by base pages
+	if (hugeEnabled() && hugeTouch(slot, frameTable.pageNum[frame]))
+		return promoteRegion(slot, frameTable.pageNum[frame], frame);
+
+	// Charge reference to another node, and move page to its process's node once it is referenced remotely enough
+	if (numaEnabled() && numaAccess(slot, frame) && frameTable.ownerPid[frame] != SHARED_PID)
+		return migratePage(slot, frame);
+	return frame;
+}
+
+// Function to load the pages predicted to follow page into frames along with it, in the same fault service
+static void prefetchPages(int slot, unsigned page)
+{
+	unsigned pages[MAX_PREFETCH_DEPTH];
+	int count = prefetchPredict(slot, page, pages);
+	for (int i = 0; i < count; i++)
+	{
+		// Shared pages another process has resident are mapped when referenced, not loaded again
+		if (ptGet(slot, pages[i]) != -1 || (shareIsShared(slot, pages[i]) && shareFrame(pages[i]) != -1))
+			continue;
+		pid_t victimPid;
+		int victimPage;
+		loadPage(slot, pages[i], false, true, &victimPid, &victimPage);
+		prefetchLoaded++;
+		if (victimPid != -1)
+			prefetchEvicted++;
+		// Prefetched pages are read right after the faulted page, without any process waiting on them
+		if (swapEnabled())
+			swapPrefetch(clockNow());
+	}
+}
+
+// Function to load the page a process is waiting on into a frame, passing in process's PCB index as parameter.
+// Takes a free frame if one exists, otherwise evicts the frame chosen by the replacement policy.
+int pageFault(int slot)
+{
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	unsigned long long startCycles = counterCycles();
+
+	// Get page number that process is waiting to load
+	unsigned page = processTable[slot].waitPage;
+	int frame = -1;
+	lastVictimPid = -1;
+	lastVictimPage = -1;
+	// Another process may have loaded a shared page while this one waited, which then only needs mapping
+	if (!processTable[slot].waitIsWrite && shareIsShared(slot, page) && shareFrame(page) != -1)
+		frame = mapShared(slot, page);
+	// Region promoted before is loaded whole as a large page if none of it is resident
+	else if (hugeEnabled() && hugeWanted(slot, page))
+		frame = loadLarge(slot, page, processTable[slot].waitIsWrite);
+	if (frame == -1)
+		frame = loadPage(slot, page, processTable[slot].waitIsWrite, false, &lastVictimPid, &lastVictimPage);
+	bool evicted = lastVictimPid != -1;
+	// Process retries its reference once granted, finding the new translation in the TLB
+	tlbMap(slot, page, frame);
+	if (prefetchEnabled())
+		prefetchPages(slot, page);
+	// Clean frames that will be evicted soon while the swap device is idle
+	if (swapEnabled())
+		swapClean(clockNow());
+
+	// Add time spent servicing fault, not counting output below
+	counterAdd(&counters->replaceCycles, counterCycles() - startCycles);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	replaceNs += (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+
+	if (evicted)
+	{
+		// Print frame swap
+		logPrintf(LOG_REFS, "oss: Clearing frame %d and swapping in p%d page %u\n", frame, slot, page);
+	}
+
+	// Return found frame
+	return frame;
+}
+
+// Function to clear occupied frame whose page has been unmapped and return it to the free stack
+static void freeFrame(int frame)
+{
+	// Policy only holds the first frame of a large page
+	if (!hugeIsLarge(frame) || (frame & (hugePages() - 1)) == 0)
+		policy->freed(frame);
+	if (bitTest(frameTable.prefetched, frame))
+		prefetchWasted++;
+	clearFrame(frame);
+	frameTable.ownPrev[frame] = -1;
+	frameTable.ownNext[frame] = -1;
+	giveFree(frame);
+}
+
+// Function to clear every page of process in slot from its page table, TLB and frame table, returning their frames to
+// the free stack and writing back the dirty ones first if writeBack is true. Only pages in the process's resident list
+// can be mapped, so clearing those leaves the whole page table empty. Returns amount of frames freed.
+static int releaseFrames(int slot, bool writeBack)
+{
+	int count = processTable[slot].residentCount;
+	tlbFlushSlot(slot);
+	int frame = processTable[slot].residentHead;
+	while (frame != -1)
+	{
+		int next = frameTable.ownNext[frame];
+		if (writeBack && swapEnabled() && bitTest(frameTable.dirty, frame))
+			swapWrite(clockNow());
+		ptClear(slot, frameTable.pageNum[frame]);
+		freeFrame(frame);
+		frame = next;
+	}
+
+	// Drop process's mappings of shared pages, freeing the frames no other process maps. Shared frames are never
+	// written, so there is nothing to write back.
+	for (int page = 0; page < sharedPages; page++)
+	{
+		if (!shareIsShared(slot, page) || (frame = ptGet(slot, page)) == -1)
+			continue;
+		ptClear(slot, page);
+		if (shareUnmap(slot, page) > 0)
+			continue;
+		freeFrame(frame);
+		count++;
+	}
+	if (hugeEnabled())
+		hugeUnmapAll(slot);
+	processTable[slot].residentHead = -1;
+	processTable[slot].residentCount = 0;
+	ptRelease(slot);
+	return count;
+}
+
+// Function to clear a terminated process's page table and return all of its frames to the free stack, leaving the
+// page table empty for the next process
+void releaseProcess(int slot)
+{
+	processTable[slot].waiting = false;
+	releaseFrames(slot, false);
+	if (sharedPages > 0)
+		shareRelease(slot);
+	if (hugeEnabled())
+		hugeRelease(slot);
+	processTable[slot].lastFaultPage = -1;
+	processTable[slot].faultStride = 0;
+	processTable[slot].strideRun = 0;
+	if (numaEnabled())
+		numaRelease(slot);
+}
+
+// Function to page out every page of a suspended process in slot, writing back the dirty ones, so the other processes
+// can use its frames. The process keeps its PCB slot and any fault it is waiting on. Returns amount of frames freed.
+int pageOutProcess(int slot)
+{
+	return releaseFrames(slot, true);
+}
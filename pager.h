@@ -0,0 +1,170 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Shared declarations for the paging core used by oss. Holds the process control block and frame table
+// structures, the page replacement policy interface, and the functions oss calls to service hits, page faults and
+// process termination. The frame table itself is managed in pager.cpp and the replacement policies live in policy.cpp.
+
+#ifndef PAGER_H
+#define PAGER_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <vector>
+#include <queue>
+#include <utility>
+#include "simclock.h"
+#include "arena.h"
+
+#define DEF_PROC 18 // Default and minimum size of process table
+#define DEF_FRAMES 256 // Default amount of frames in frame table
+#define DEF_PAGES 32 // Default amount of pages in each process's page table
+#define DEF_PAGE_SIZE 1024 // Default page size in bytes
+
+// Structure for Process Control Block
+typedef struct
+{
+        int occupied; // Either true or false, determines if slot is occupied
+        pid_t pid; // Process ID of this child
+        int startSeconds; // Second time when it was forked
+        int startNano; // Nanosecond time when it was forked
+	int* pageTable; // Flat page table, frame of each of the process's pageCount pages, -1 if not resident
+	void* pageRoot; // Root node of radix page table, NULL until a page is mapped
+	bool waiting; // True if process is currently waiting due to page fault
+	int waitPage; // Page number processes is waiting to be loaded
+	unsigned waitAddress; // Address of waiting reference
+	bool waitIsWrite; // True if waiting reference is a write
+	long long waitSec; // Second time of page fault
+	long long waitNano; // Nanosecond time of page fault
+	int residentHead; // First frame in list of frames holding this process's pages, -1 if none
+	int residentCount; // Amount of frames holding this process's pages
+	int lastFaultPage; // Page of process's last fault, -1 if none, for the stride detector
+	long long faultStride; // Distance between process's last two faults
+	int strideRun; // Faults in a row that were faultStride apart, after the first
+} PCB;
+
+// Structure for frame table, kept as one array per field indexed by frame so a scan over one field only touches that
+// field. Occupied, dirty and reference flags are bitsets holding 64 frames per word.
+typedef struct
+{
+	unsigned long long* occupied; // Bit set if frame is in use
+	unsigned long long* dirty; // Bit set if frame has been written
+	unsigned long long* refBit; // Reference bit, set on every access and cleared by the clock hand
+	unsigned long long* prefetched; // Bit set if frame was filled by prefetching and has not been referenced since
+	long long* lastRefNs; // System time of last access in ns
+	pid_t* ownerPid; // PID of process that owns page in frame
+	int* ownerSlot; // PCB slot of process that owns page in frame
+	int* pageNum; // Page number in frame
+	int* lruPrev; // Frame used more recently than this one in policy's recency list, -1 if most recent
+	int* lruNext; // Frame used less recently than this one in policy's recency list, -1 if least recent
+	int* ownPrev; // Previous frame in owner's resident list, -1 if first
+	int* ownNext; // Next frame in owner's resident list, -1 if last
+	int* hashNext; // Next frame in hashed page table's bucket chain, -1 if last, NULL unless page tables are hashed
+} frameTable_t;
+
+// Function to read bit i of a bitset
+static inline bool bitTest(const unsigned long long* set, int i)
+{
+	return (set[i >> 6] >> (i & 63)) & 1;
+}
+
+// Function to set bit i of a bitset to value
+static inline void bitAssign(unsigned long long* set, int i, bool value)
+{
+	if (value)
+		set[i >> 6] |= 1ULL << (i & 63);
+	else
+		set[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+int bitCount(const unsigned long long* set, int n);
+
+// Bitset with a bit for every range of 64 frames whose printed fields changed since the tables were last printed, NULL
+// unless only changes are printed
+extern unsigned long long* frameChangedRanges;
+
+// Function to mark range holding frame as changed, which shard threads may do at the same time as each other
+static inline void frameChanged(int frame)
+{
+	if (frameChangedRanges != NULL)
+		__atomic_fetch_or(&frameChangedRanges[frame >> 12], 1ULL << ((frame >> 6) & 63), __ATOMIC_RELAXED);
+}
+
+// Structure for a page replacement policy. Frames on the free stack are handed out before the policy is asked for a
+// victim, so victim() is only called while every frame is occupied.
+typedef struct
+{
+	const char* name; // Name used to select policy with -p
+	void (*init)(); // Reset policy state for an empty frame table
+	void (*hit)(int frame); // Resident page in frame was referenced
+	void (*miss)(unsigned long long key); // Page identified by key faulted, called before a frame is chosen
+	int (*victim)(); // Choose an occupied frame to evict and remove it from policy's lists
+	void (*loaded)(int frame); // Faulted page has been placed in frame
+	void (*freed)(int frame); // Occupied frame was released because its owner terminated
+	int (*cold)(int* frames, int max); // Fill frames with up to max frames soonest to be evicted, soonest first, without
+	                                   // changing policy state, returns amount filled. NULL if policy keeps no order.
+	void (*moved)(int from, int to); // Page in occupied frame from was copied to free frame to, which takes its place
+} policy_t;
+
+// Global tables shared between oss and the paging core
+extern PCB* processTable; // Process control block table to track child processes
+extern frameTable_t frameTable; // Frame table of frameNum frames
+extern const policy_t* policy; // Page replacement policy in use
+extern arena_t pagerArena; // Arena every table of the pager is allocated from, released by pagerFree
+
+// Table sizes, set once by pagerInit
+extern int maxProc; // Amount of PCB slots in process table
+extern int frameNum; // Amount of frames in frame table
+extern int pageCount; // Amount of pages in each process's page table
+extern unsigned pageSize; // Size of a page in bytes
+
+extern int freeTop; // Amount of frames currently free
+extern pid_t lastVictimPid; // PID whose page was evicted by last page fault, -1 if a free frame was used
+extern int lastVictimPage; // Page evicted by last page fault, -1 if a free frame was used
+extern long long replaceNs; // Total real time spent choosing and loading frames for page faults
+
+// Function to build key identifying a page of a process for policies that track pages outside the frame table
+static inline unsigned long long pageKey(pid_t pid, unsigned page)
+{
+	return ((unsigned long long)(unsigned)pid << 32) | page;
+}
+
+// Wait queue of processes blocked on page faults, earliest completion on top
+typedef std::pair<long long, int> waitEntry_t; // Completion time in ns and PCB slot
+typedef std::priority_queue<waitEntry_t, std::vector<waitEntry_t>, std::greater<waitEntry_t> > waitQueue_t;
+
+// Paging core functions, defined in pager.cpp
+void pagerInit(int procs, int frames, int pages, unsigned size);
+void pagerFree();
+int slotAlloc();
+void slotBind(int slot, pid_t pid);
+int slotOf(pid_t pid);
+void slotFree(int slot);
+int pageHit(int slot, int frame, bool isWrite);
+int pageLookup(int slot, unsigned page);
+int pageShared(int slot, unsigned page);
+int pageFault(int slot);
+void releaseProcess(int slot);
+int pageOutProcess(int slot);
+void residentPush(int slot, int frame);
+void residentUnlink(int slot, int frame);
+
+// Helpers for policies that keep frames on a recency list through lruPrev/lruNext
+typedef struct
+{
+	int head; // Most recently used frame in list
+	int tail; // Least recently used frame in list
+	int size; // Amount of frames in list
+} frameList_t;
+
+void listInit(frameList_t* list);
+void listUnlink(frameList_t* list, int frame);
+void listPushFront(frameList_t* list, int frame);
+void listReplace(frameList_t* list, int from, int to);
+
+// Replacement policy lookup and offline optimal policy setup, defined in policy.cpp
+const policy_t* findPolicy(const char* name);
+void printPolicies(FILE* out);
+void optSetFuture(const std::vector<long long>& nextUse);
+
+#endif
@@ -0,0 +1,276 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Page tables of the processes in the process table, in the kind selected with -P. Radix tables use as
+// many levels as the address space needs, with the top node only indexing the bits left over, so address spaces of up
+// to RADIX_ENTRIES pages are a single leaf and a lookup reads one entry per level. Their nodes come from a pool of
+// fixed size nodes that are returned when the process terminates. Hashed tables chain the frames of each bucket through
+// the frame table.
+
+#include <stdio.h>
+#include <string.h>
+#include "pager.h"
+#include "arena.h"
+#include "pagetable.h"
+
+int pageTableKind = PT_FLAT;
+long long ptBytes = 0;
+long long ptPeakBytes = 0;
+
+static pool_t dirPool; // Interior nodes of radix tables, RADIX_ENTRIES pointers each
+static pool_t leafPool; // Leaf nodes of radix tables, RADIX_ENTRIES frames each
+static int radixTopShift = 0; // Shift of the page number giving the index into a root node, 0 if the root is a leaf
+
+static int* hashHeads = NULL; // First frame in chain of each bucket of hashed table, -1 if bucket is empty
+static int hashShift = 0; // Shift of hashed key giving its bucket
+
+// Function to parse page table kind name into kind, returns false if name is not a kind
+bool ptParse(const char* name, int* kind)
+{
+	if (strcmp(name, "flat") == 0)
+		*kind = PT_FLAT;
+	else if (strcmp(name, "radix") == 0)
+		*kind = PT_RADIX;
+	else if (strcmp(name, "hash") == 0)
+		*kind = PT_HASH;
+	else
+		return false;
+	return true;
+}
+
+// Function to give name of page table kind
+const char* ptName(int kind)
+{
+	if (kind == PT_RADIX)
+		return "radix";
+	if (kind == PT_HASH)
+		return "hash";
+	return "flat";
+}
+
+// Function to add bytes to the amount held by page tables, keeping track of the most held at once
+static void ptCharge(long long bytes)
+{
+	ptBytes += bytes;
+	if (ptBytes > ptPeakBytes)
+		ptPeakBytes = ptBytes;
+}
+
+// Function to take a radix node from pool
+static void* nodeTake(pool_t* pool)
+{
+	ptCharge(pool->blockSize);
+	return poolTake(pool);
+}
+
+// Function to return radix node to pool
+static void nodeGive(pool_t* pool, void* node)
+{
+	ptBytes -= pool->blockSize;
+	poolGive(pool, node);
+}
+
+// Function to find bucket of page of process with pid in hashed table
+static unsigned hashBucket(pid_t pid, unsigned page)
+{
+	return (unsigned)((pageKey(pid, page) * 0x9E3779B97F4A7C15ULL) >> hashShift);
+}
+
+// Function to set up an empty page table of the selected kind for every PCB slot from the pager's arena, called by
+// pagerInit once the process table and frame table exist
+void ptInit()
+{
+	ptBytes = 0;
+	ptPeakBytes = 0;
+	frameTable.hashNext = NULL;
+	poolInit(&dirPool, RADIX_ENTRIES * sizeof(void*), &pagerArena);
+	poolInit(&leafPool, RADIX_ENTRIES * sizeof(int), &pagerArena);
+	for (int i = 0; i < maxProc; i++)
+	{
+		processTable[i].pageTable = NULL;
+		processTable[i].pageRoot = NULL;
+	}
+
+	if (pageTableKind == PT_FLAT)
+	{
+		// Every page table in one block, with every page not resident
+		int* pageTables = arenaArray<int>(&pagerArena, (size_t)maxProc * pageCount);
+		for (size_t i = 0; i < (size_t)maxProc * pageCount; i++)
+		{
+			pageTables[i] = -1;
+		}
+		for (int i = 0; i < maxProc; i++)
+		{
+			processTable[i].pageTable = pageTables + (size_t)i * pageCount;
+		}
+		ptCharge((long long)maxProc * pageCount * sizeof(int));
+	}
+	else if (pageTableKind == PT_RADIX)
+	{
+		// Use enough levels to index every page number, every level below the root indexing RADIX_BITS bits
+		int bits = 1;
+		while (bits < 32 && (1ULL << bits) < (unsigned long long)pageCount)
+		{
+			bits++;
+		}
+		radixTopShift = ((bits - 1) / RADIX_BITS) * RADIX_BITS;
+	}
+	else
+	{
+		// Use at least as many buckets as frames, a power of two so the top bits of the hashed key pick the bucket
+		int bits = 1;
+		while ((1LL << bits) < frameNum)
+		{
+			bits++;
+		}
+		hashShift = 64 - bits;
+		hashHeads = arenaArray<int>(&pagerArena, 1LL << bits);
+		for (long long i = 0; i < (1LL << bits); i++)
+		{
+			hashHeads[i] = -1;
+		}
+		frameTable.hashNext = arenaArray<int>(&pagerArena, frameNum);
+		ptCharge(((1LL << bits) + frameNum) * sizeof(int));
+	}
+}
+
+// Function to forget every page table set up by ptInit, before pagerFree releases the arena holding them
+void ptFree()
+{
+	hashHeads = NULL;
+	frameTable.hashNext = NULL;
+	poolInit(&dirPool, dirPool.blockSize, &pagerArena);
+	poolInit(&leafPool, leafPool.blockSize, &pagerArena);
+	ptBytes = 0;
+}
+
+// Function to find frame holding page of process in slot in its page table, -1 if it is not resident
+int ptGet(int slot, unsigned page)
+{
+	if (pageTableKind == PT_FLAT)
+		return processTable[slot].pageTable[page];
+
+	if (pageTableKind == PT_RADIX)
+	{
+		// Walk down to the leaf, stopping at a node not yet allocated
+		void* node = processTable[slot].pageRoot;
+		for (int shift = radixTopShift; shift > 0 && node != NULL; shift -= RADIX_BITS)
+		{
+			node = ((void**)node)[(page >> shift) & (RADIX_ENTRIES - 1)];
+		}
+		if (node == NULL)
+			return -1;
+		return ((int*)node)[page & (RADIX_ENTRIES - 1)];
+	}
+
+	// Follow bucket's chain through the frame table to the frame holding page
+	pid_t pid = processTable[slot].pid;
+	for (int frame = hashHeads[hashBucket(pid, page)]; frame != -1; frame = frameTable.hashNext[frame])
+	{
+		if (frameTable.pageNum[frame] == (int)page && frameTable.ownerPid[frame] == pid)
+			return frame;
+	}
+	return -1;
+}
+
+// Function to map page of process in slot to frame. In a hashed table, frame must already hold page's owner and number.
+void ptSet(int slot, unsigned page, int frame)
+{
+	if (pageTableKind == PT_FLAT)
+	{
+		processTable[slot].pageTable[page] = frame;
+		return;
+	}
+
+	if (pageTableKind == PT_RADIX)
+	{
+		// Walk down to the leaf, taking every missing node from the pools on the way
+		void** link = &processTable[slot].pageRoot;
+		for (int shift = radixTopShift; shift > 0; shift -= RADIX_BITS)
+		{
+			if (*link == NULL)
+			{
+				*link = nodeTake(&dirPool);
+				memset(*link, 0, dirPool.blockSize);
+			}
+			link = &((void**)*link)[(page >> shift) & (RADIX_ENTRIES - 1)];
+		}
+		if (*link == NULL)
+		{
+			int* leaf = (int*)nodeTake(&leafPool);
+			for (int i = 0; i < RADIX_ENTRIES; i++)
+			{
+				leaf[i] = -1;
+			}
+			*link = leaf;
+		}
+		((int*)*link)[page & (RADIX_ENTRIES - 1)] = frame;
+		return;
+	}
+
+	unsigned bucket = hashBucket(processTable[slot].pid, page);
+	frameTable.hashNext[frame] = hashHeads[bucket];
+	hashHeads[bucket] = frame;
+}
+
+// Function to unmap page of process in slot, while its frame still holds page's owner and number
+void ptClear(int slot, unsigned page)
+{
+	if (pageTableKind == PT_FLAT)
+	{
+		processTable[slot].pageTable[page] = -1;
+		return;
+	}
+
+	if (pageTableKind == PT_RADIX)
+	{
+		void* node = processTable[slot].pageRoot;
+		for (int shift = radixTopShift; shift > 0 && node != NULL; shift -= RADIX_BITS)
+		{
+			node = ((void**)node)[(page >> shift) & (RADIX_ENTRIES - 1)];
+		}
+		if (node != NULL)
+			((int*)node)[page & (RADIX_ENTRIES - 1)] = -1;
+		return;
+	}
+
+	// Unlink frame holding page from its bucket's chain
+	pid_t pid = processTable[slot].pid;
+	int* link = &hashHeads[hashBucket(pid, page)];
+	while (*link != -1)
+	{
+		int frame = *link;
+		if (frameTable.pageNum[frame] == (int)page && frameTable.ownerPid[frame] == pid)
+		{
+			*link = frameTable.hashNext[frame];
+			return;
+		}
+		link = &frameTable.hashNext[frame];
+	}
+}
+
+// Function to return radix node and every node below it to the pools, shift being the one used to index node
+static void radixFreeNode(void* node, int shift)
+{
+	if (shift == 0)
+	{
+		nodeGive(&leafPool, node);
+		return;
+	}
+	for (int i = 0; i < RADIX_ENTRIES; i++)
+	{
+		void* child = ((void**)node)[i];
+		if (child != NULL)
+			radixFreeNode(child, shift - RADIX_BITS);
+	}
+	nodeGive(&dirPool, node);
+}
+
+// Function to give back the nodes of a terminated process's radix table, once every page in it has been cleared
+void ptRelease(int slot)
+{
+	if (pageTableKind != PT_RADIX || processTable[slot].pageRoot == NULL)
+		return;
+	radixFreeNode(processTable[slot].pageRoot, radixTopShift);
+	processTable[slot].pageRoot = NULL;
+}
@@ -0,0 +1,34 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Page tables of the processes in the process table. A flat table keeps a frame entry for every page of
+// every PCB slot. A radix table is a tree of nodes of RADIX_ENTRIES entries taken from a pool the first time a page
+// under them is mapped, so a process only holds nodes for the parts of its address space it has touched. A hashed
+// table is inverted, with one chain per bucket threaded through the frame table and keyed on pid and page, so its size
+// depends only on the amount of frames.
+
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+// Page table kinds
+#define PT_FLAT 0 // Array of pageCount frames for each PCB slot
+#define PT_RADIX 1 // Tree of lazily allocated nodes for each PCB slot
+#define PT_HASH 2 // One table of frameNum entries shared by every process
+
+#define RADIX_BITS 9 // Bits of page number indexed by each level of a radix table
+#define RADIX_ENTRIES (1 << RADIX_BITS) // Entries in each radix node
+
+extern int pageTableKind; // One of the PT_ values, set before pagerInit
+extern long long ptBytes; // Bytes held by page tables
+extern long long ptPeakBytes; // Most bytes held by page tables at once
+
+bool ptParse(const char* name, int* kind);
+const char* ptName(int kind);
+void ptInit();
+void ptFree();
+int ptGet(int slot, unsigned page);
+void ptSet(int slot, unsigned page, int frame);
+void ptClear(int slot, unsigned page);
+void ptRelease(int slot);
+
+#endif
@@ -0,0 +1,625 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Page replacement policies for the paging core. Each policy fills in a policy_t and is selected by name
+// with the -p option of oss. Provides exact LRU, CLOCK, FIFO second-chance, enhanced CLOCK that prefers clean frames,
+// ARC, and Belady's optimal policy, which can only run while replaying a recorded reference string. Also provides LRU
+// by scanning the timestamp array of the frame table, vectorized with AVX2 where the processor supports it, as the
+// fallback for policies that keep no recency list.
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include "pager.h"
+#include "counters.h"
+
+using namespace std;
+
+// Function shared by policies that do no work for an event
+static void noMiss(unsigned long long) {}
+
+// ---- Exact LRU ----
+// Every frame sits on one recency list. Hits move the frame to the front and the tail is always the victim.
+
+static frameList_t lruList;
+
+static void lruInit()
+{
+	listInit(&lruList);
+}
+
+// Function to move referenced frame to front of LRU list
+static void lruHit(int frame)
+{
+	// Frame is already most recently used
+	if (lruList.head == frame)
+		return;
+	listUnlink(&lruList, frame);
+	listPushFront(&lruList, frame);
+}
+
+// Function to take frame at tail of LRU list, which is the frame used the longest time ago
+static int lruVictim()
+{
+	counterAdd(&counters->scanFrames, 1);
+	int frame = lruList.tail;
+	listUnlink(&lruList, frame);
+	return frame;
+}
+
+static void lruLoaded(int frame)
+{
+	listPushFront(&lruList, frame);
+}
+
+static void lruFreed(int frame)
+{
+	listUnlink(&lruList, frame);
+}
+
+static void lruMoved(int from, int to)
+{
+	listReplace(&lruList, from, to);
+}
+
+// Function to walk recency list from its tail, giving up to max frames used the longest time ago
+static int listCold(const frameList_t* list, int* frames, int max)
+{
+	int count = 0;
+	for (int frame = list->tail; frame != -1 && count < max; frame = frameTable.lruPrev[frame])
+	{
+		frames[count++] = frame;
+	}
+	return count;
+}
+
+static int lruCold(int* frames, int max)
+{
+	return listCold(&lruList, frames, max);
+}
+
+// ---- CLOCK ----
+// A hand sweeps the frame table in order. Frames with their reference bit set get it cleared and are skipped.
+
+static int clockHand = 0;
+
+static void clockInit()
+{
+	clockHand = 0;
+}
+
+// Function shared by policies whose state is only the reference bit the pager already sets
+static void clockHit(int) {}
+static void clockLoaded(int) {}
+static void clockFreed(int) {}
+static void clockMoved(int, int) {}
+
+// Function to give up to max unreferenced frames ahead of clock hand, in the order the hand will reach them
+static int clockCold(int* frames, int max)
+{
+	int count = 0;
+	for (int i = 0; i < frameNum && count < max; i++)
+	{
+		int frame = (clockHand + i) % frameNum;
+		if (!bitTest(frameTable.refBit, frame))
+			frames[count++] = frame;
+	}
+	return count;
+}
+
+// Function to advance clock hand until a frame with a clear reference bit is found
+static int clockVictim()
+{
+	for (int scanned = 1; ; scanned++)
+	{
+		int frame = clockHand;
+		clockHand = (clockHand + 1) % frameNum;
+		if (!bitTest(frameTable.refBit, frame))
+		{
+			counterAdd(&counters->scanFrames, scanned);
+			return frame;
+		}
+		// Give frame a second chance
+		bitAssign(frameTable.refBit, frame, false);
+	}
+}
+
+// ---- FIFO second-chance ----
+// Frames are queued in load order. A referenced frame at the tail is moved back to the front instead of evicted.
+
+static frameList_t fifoList;
+
+static void secondInit()
+{
+	listInit(&fifoList);
+}
+
+static void secondHit(int) {}
+
+// Function to pop oldest frame, requeueing it if it was referenced since it was last checked
+static int secondVictim()
+{
+	for (int scanned = 1; ; scanned++)
+	{
+		int frame = fifoList.tail;
+		listUnlink(&fifoList, frame);
+		if (!bitTest(frameTable.refBit, frame))
+		{
+			counterAdd(&counters->scanFrames, scanned);
+			return frame;
+		}
+		bitAssign(frameTable.refBit, frame, false);
+		listPushFront(&fifoList, frame);
+	}
+}
+
+static void secondLoaded(int frame)
+{
+	listPushFront(&fifoList, frame);
+}
+
+static void secondFreed(int frame)
+{
+	listUnlink(&fifoList, frame);
+}
+
+static void secondMoved(int from, int to)
+{
+	listReplace(&fifoList, from, to);
+}
+
+// Function to give up to max unreferenced frames from the tail of the queue, which will be evicted in that order
+static int secondCold(int* frames, int max)
+{
+	int count = 0;
+	for (int frame = fifoList.tail; frame != -1 && count < max; frame = frameTable.lruPrev[frame])
+	{
+		if (!bitTest(frameTable.refBit, frame))
+			frames[count++] = frame;
+	}
+	return count;
+}
+
+// ---- Enhanced CLOCK ----
+// Frames are classed by (reference bit, dirty bit). The hand first looks for an unreferenced clean frame without
+// changing anything, then for an unreferenced dirty frame while clearing reference bits, and repeats.
+
+static int eclockVictim()
+{
+	for (int passes = 0; ; passes += 2)
+	{
+		// First pass, look for frame that is neither referenced nor dirty
+		for (int i = 0; i < frameNum; i++)
+		{
+			int frame = clockHand;
+			clockHand = (clockHand + 1) % frameNum;
+			if (!bitTest(frameTable.refBit, frame) && !bitTest(frameTable.dirty, frame))
+			{
+				counterAdd(&counters->scanFrames, (long long)passes * frameNum + i + 1);
+				return frame;
+			}
+		}
+
+		// Second pass, look for unreferenced dirty frame, clearing reference bits of frames passed
+		for (int i = 0; i < frameNum; i++)
+		{
+			int frame = clockHand;
+			clockHand = (clockHand + 1) % frameNum;
+			if (!bitTest(frameTable.refBit, frame) && bitTest(frameTable.dirty, frame))
+			{
+				counterAdd(&counters->scanFrames, (long long)(passes + 1) * frameNum + i + 1);
+				return frame;
+			}
+			bitAssign(frameTable.refBit, frame, false);
+		}
+	}
+}
+
+// ---- LRU by timestamp scan ----
+// Keeps no state of its own. The victim is the frame with the oldest last reference time, found by scanning the
+// timestamp array, where the earliest frame wins ties.
+
+// Function to find index of smallest of n values, earliest index on ties
+static int argminScalar(const long long* v, int n)
+{
+	int best = 0;
+	for (int i = 1; i < n; i++)
+	{
+		if (v[i] < v[best])
+			best = i;
+	}
+	return best;
+}
+
+#if defined(__x86_64__)
+// Function to find index of smallest of n values four at a time with AVX2, earliest index on ties
+__attribute__((target("avx2"))) static int argminAvx2(const long long* v, int n)
+{
+	if (n < 8)
+		return argminScalar(v, n);
+
+	// Each lane keeps smallest value it has seen and its index, replacing them only on a strictly smaller value
+	__m256i best = _mm256_loadu_si256((const __m256i*)v);
+	__m256i bestIdx = _mm256_set_epi64x(3, 2, 1, 0);
+	__m256i idx = bestIdx;
+	const __m256i four = _mm256_set1_epi64x(4);
+	int i = 4;
+	for (; i + 4 <= n; i += 4)
+	{
+		idx = _mm256_add_epi64(idx, four);
+		__m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+		__m256i less = _mm256_cmpgt_epi64(best, x);
+		best = _mm256_blendv_epi8(best, x, less);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, less);
+	}
+
+	// Reduce lanes, then check values left over after last full group
+	long long vals[4];
+	long long idxs[4];
+	_mm256_storeu_si256((__m256i*)vals, best);
+	_mm256_storeu_si256((__m256i*)idxs, bestIdx);
+	int min = idxs[0];
+	long long minVal = vals[0];
+	for (int l = 1; l < 4; l++)
+	{
+		if (vals[l] < minVal || (vals[l] == minVal && idxs[l] < min))
+		{
+			minVal = vals[l];
+			min = idxs[l];
+		}
+	}
+	for (; i < n; i++)
+	{
+		if (v[i] < minVal)
+		{
+			minVal = v[i];
+			min = i;
+		}
+	}
+	return min;
+}
+#endif
+
+static int (*argminFn)(const long long* v, int n) = argminScalar; // Argmin used for victim scan
+
+// Function to pick vectorized argmin if processor supports it
+static void scanInit()
+{
+	argminFn = argminScalar;
+#if defined(__x86_64__)
+	if (__builtin_cpu_supports("avx2"))
+		argminFn = argminAvx2;
+#endif
+}
+
+// Function to give up to max occupied frames with the oldest last reference times, oldest first, kept sorted by
+// insertion while scanning the timestamp array once
+static int scanCold(int* frames, int max)
+{
+	int count = 0;
+	for (int frame = 0; frame < frameNum; frame++)
+	{
+		if (!bitTest(frameTable.occupied, frame))
+			continue;
+		long long t = frameTable.lastRefNs[frame];
+		if (count == max && t >= frameTable.lastRefNs[frames[count - 1]])
+			continue;
+		int i = count < max ? count++ : count - 1;
+		for (; i > 0 && frameTable.lastRefNs[frames[i - 1]] > t; i--)
+		{
+			frames[i] = frames[i - 1];
+		}
+		frames[i] = frame;
+	}
+	return count;
+}
+
+// Function to take frame with oldest last reference time
+static int scanVictim()
+{
+	counterAdd(&counters->scanFrames, frameNum);
+	return argminFn(frameTable.lastRefNs, frameNum);
+}
+
+// ---- ARC ----
+// Resident frames are split between T1 (seen once recently) and T2 (seen at least twice). B1 and B2 remember keys of
+// pages recently evicted from T1 and T2. A fault on a key in B1 grows the target size p of T1, a fault on a key in B2
+// shrinks it, and victims are taken from T1 or T2 depending on how T1 compares to p.
+
+static frameList_t arcT1;
+static frameList_t arcT2;
+static vector<int> arcWhere; // Resident list of each frame, 1 for T1 and 2 for T2
+
+// Ghost list of keys, most recent at front, with an index for constant time lookup. Nodes of both come from pools, so
+// once the lists have filled, remembering and forgetting evicted keys does not call the heap.
+typedef list<unsigned long long, poolAllocator<unsigned long long> > ghostKeys_t;
+typedef unordered_map<unsigned long long, ghostKeys_t::iterator, hash<unsigned long long>, equal_to<unsigned long long>,
+	poolAllocator<pair<const unsigned long long, ghostKeys_t::iterator> > > ghostIndex_t;
+typedef struct
+{
+	ghostKeys_t keys;
+	ghostIndex_t index;
+} ghostList_t;
+
+static ghostList_t arcB1;
+static ghostList_t arcB2;
+static int arcP = 0; // Target size of T1
+static int arcTarget = 1; // Resident list faulted page will be placed on once loaded
+static bool arcFromB2 = false; // True if faulted page was found in B2
+static bool arcDropT1 = false; // True if victim should be dropped from T1 without remembering it in B1
+
+// Function to add key to front of ghost list
+static void ghostPush(ghostList_t* ghost, unsigned long long key)
+{
+	ghost->keys.push_front(key);
+	ghost->index[key] = ghost->keys.begin();
+}
+
+// Function to remove key from ghost list if present, returns true if it was found
+static bool ghostErase(ghostList_t* ghost, unsigned long long key)
+{
+	auto it = ghost->index.find(key);
+	if (it == ghost->index.end())
+		return false;
+	ghost->keys.erase(it->second);
+	ghost->index.erase(it);
+	return true;
+}
+
+// Function to forget least recently evicted key in ghost list
+static void ghostPopBack(ghostList_t* ghost)
+{
+	if (ghost->keys.empty())
+		return;
+	ghost->index.erase(ghost->keys.back());
+	ghost->keys.pop_back();
+}
+
+static void arcInit()
+{
+	listInit(&arcT1);
+	listInit(&arcT2);
+	arcWhere.assign(frameNum, 0);
+	arcB1.keys.clear();
+	arcB1.index.clear();
+	arcB2.keys.clear();
+	arcB2.index.clear();
+	// Each ghost list holds at most one key per frame, so its index never needs to grow
+	arcB1.index.reserve(frameNum);
+	arcB2.index.reserve(frameNum);
+	arcP = 0;
+	arcTarget = 1;
+	arcFromB2 = false;
+	arcDropT1 = false;
+}
+
+// Function to move referenced frame to front of T2
+static void arcHit(int frame)
+{
+	if (arcWhere[frame] == 1)
+		listUnlink(&arcT1, frame);
+	else
+		listUnlink(&arcT2, frame);
+	listPushFront(&arcT2, frame);
+	arcWhere[frame] = 2;
+}
+
+// Function to adapt target size from ghost hits and trim ghost lists before a victim is chosen
+static void arcMiss(unsigned long long key)
+{
+	int b1 = arcB1.keys.size();
+	int b2 = arcB2.keys.size();
+	arcFromB2 = false;
+	arcDropT1 = false;
+
+	if (arcB1.index.count(key)) // Recently evicted from T1, T1 should be larger
+	{
+		int delta = b1 >= b2 ? 1 : b2 / b1;
+		arcP = arcP + delta < frameNum ? arcP + delta : frameNum;
+		ghostErase(&arcB1, key);
+		arcTarget = 2;
+	}
+	else if (arcB2.index.count(key)) // Recently evicted from T2, T2 should be larger
+	{
+		int delta = b2 >= b1 ? 1 : b1 / b2;
+		arcP = arcP - delta > 0 ? arcP - delta : 0;
+		ghostErase(&arcB2, key);
+		arcFromB2 = true;
+		arcTarget = 2;
+	}
+	else // Page not seen recently
+	{
+		arcTarget = 1;
+		if (arcT1.size + b1 >= frameNum)
+		{
+			// T1 and B1 are full, forget oldest B1 key or drop T1's tail outright if B1 is empty
+			if (arcT1.size < frameNum)
+				ghostPopBack(&arcB1);
+			else
+				arcDropT1 = true;
+		}
+		else if (arcT1.size + arcT2.size + b1 + b2 >= 2 * frameNum)
+		{
+			ghostPopBack(&arcB2);
+		}
+	}
+}
+
+// Function to evict tail of T1 or T2, remembering its key in the matching ghost list
+static int arcVictim()
+{
+	counterAdd(&counters->scanFrames, 1);
+	int frame;
+	if (arcT1.size > 0 && (arcDropT1 || (arcFromB2 && arcT1.size == arcP) || arcT1.size > arcP || arcT2.size == 0))
+	{
+		frame = arcT1.tail;
+		listUnlink(&arcT1, frame);
+		if (!arcDropT1)
+			ghostPush(&arcB1, pageKey(frameTable.ownerPid[frame], frameTable.pageNum[frame]));
+	}
+	else
+	{
+		frame = arcT2.tail;
+		listUnlink(&arcT2, frame);
+		ghostPush(&arcB2, pageKey(frameTable.ownerPid[frame], frameTable.pageNum[frame]));
+	}
+	return frame;
+}
+
+static void arcLoaded(int frame)
+{
+	if (arcTarget == 1)
+		listPushFront(&arcT1, frame);
+	else
+		listPushFront(&arcT2, frame);
+	arcWhere[frame] = arcTarget;
+}
+
+static void arcFreed(int frame)
+{
+	if (arcWhere[frame] == 1)
+		listUnlink(&arcT1, frame);
+	else
+		listUnlink(&arcT2, frame);
+}
+
+static void arcMoved(int from, int to)
+{
+	listReplace(arcWhere[from] == 1 ? &arcT1 : &arcT2, from, to);
+	arcWhere[to] = arcWhere[from];
+}
+
+// Function to give up to max frames from the tail of the list victims are currently taken from, then the other list
+static int arcCold(int* frames, int max)
+{
+	bool fromT1 = arcT1.size > 0 && (arcT1.size > arcP || arcT2.size == 0);
+	int count = listCold(fromT1 ? &arcT1 : &arcT2, frames, max);
+	return count + listCold(fromT1 ? &arcT2 : &arcT1, frames + count, max - count);
+}
+
+// ---- Belady optimal ----
+// Evicts the frame whose page is next referenced furthest in the future. The position of the next reference to the
+// same page is precomputed for every reference of the replayed reference string, and resident frames are kept ordered
+// by that position so the victim is always the last entry.
+
+static vector<long long> optNext; // Index of next reference to same page for each reference, LLONG_MAX if none
+static long long optCursor = 0; // Index of reference currently being serviced
+static vector<long long> optFrameNext; // Next use of page held in each frame
+static long long optPending = LLONG_MAX; // Next use of page currently being faulted in
+typedef set<pair<long long, int>, less<pair<long long, int> >, poolAllocator<pair<long long, int> > > optOrder_t;
+static optOrder_t optByNext; // Resident frames ordered by next use, with nodes from a pool
+
+// Function to give optimal policy the next use of every reference in the reference string being replayed
+void optSetFuture(const vector<long long>& nextUse)
+{
+	optNext = nextUse;
+}
+
+// Function to get next use of page referenced at cursor and move cursor forward
+static long long optAdvance()
+{
+	long long next = LLONG_MAX;
+	if (optCursor < (long long)optNext.size())
+		next = optNext[optCursor];
+	optCursor++;
+	return next;
+}
+
+static void optInit()
+{
+	optCursor = 0;
+	optPending = LLONG_MAX;
+	optFrameNext.assign(frameNum, LLONG_MAX);
+	optByNext.clear();
+}
+
+static void optHit(int frame)
+{
+	optByNext.erase(make_pair(optFrameNext[frame], frame));
+	optFrameNext[frame] = optAdvance();
+	optByNext.insert(make_pair(optFrameNext[frame], frame));
+}
+
+static void optMiss(unsigned long long)
+{
+	optPending = optAdvance();
+}
+
+// Function to evict frame whose next use is furthest away
+static int optVictim()
+{
+	counterAdd(&counters->scanFrames, 1);
+	auto last = prev(optByNext.end());
+	int frame = last->second;
+	optByNext.erase(last);
+	return frame;
+}
+
+static void optLoaded(int frame)
+{
+	optFrameNext[frame] = optPending;
+	optByNext.insert(make_pair(optFrameNext[frame], frame));
+}
+
+static void optFreed(int frame)
+{
+	optByNext.erase(make_pair(optFrameNext[frame], frame));
+}
+
+static void optMoved(int from, int to)
+{
+	optByNext.erase(make_pair(optFrameNext[from], from));
+	optFrameNext[to] = optFrameNext[from];
+	optByNext.insert(make_pair(optFrameNext[to], to));
+}
+
+// Function to give up to max frames whose next use is furthest away, furthest first
+static int optCold(int* frames, int max)
+{
+	int count = 0;
+	for (auto it = optByNext.rbegin(); it != optByNext.rend() && count < max; ++it)
+	{
+		frames[count++] = it->second;
+	}
+	return count;
+}
+
+// Table of all available policies, first entry is the default
+static const policy_t policies[] =
+{
+	{ "lru", lruInit, lruHit, noMiss, lruVictim, lruLoaded, lruFreed, lruCold, lruMoved },
+	{ "clock", clockInit, clockHit, noMiss, clockVictim, clockLoaded, clockFreed, clockCold, clockMoved },
+	{ "second", secondInit, secondHit, noMiss, secondVictim, secondLoaded, secondFreed, secondCold, secondMoved },
+	{ "eclock", clockInit, clockHit, noMiss, eclockVictim, clockLoaded, clockFreed, clockCold, clockMoved },
+	{ "lruscan", scanInit, clockHit, noMiss, scanVictim, clockLoaded, clockFreed, scanCold, clockMoved },
+	{ "arc", arcInit, arcHit, arcMiss, arcVictim, arcLoaded, arcFreed, arcCold, arcMoved },
+	{ "opt", optInit, optHit, optMiss, optVictim, optLoaded, optFreed, optCold, optMoved },
+};
+
+// Function to find policy by name, returns NULL if no policy has that name
+const policy_t* findPolicy(const char* name)
+{
+	for (unsigned i = 0; i < sizeof(policies) / sizeof(policies[0]); i++)
+	{
+		if (strcmp(policies[i].name, name) == 0)
+			return &policies[i];
+	}
+	return NULL;
+}
+
+// Function to print names of all policies
+void printPolicies(FILE* out)
+{
+	for (unsigned i = 0; i < sizeof(policies) / sizeof(policies[0]); i++)
+	{
+		fprintf(out, " %s", policies[i].name);
+	}
+}
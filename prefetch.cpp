@@ -0,0 +1,102 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Prefetch settings and prediction. The stride detector keeps the page and distance of each process's last
+// fault in its PCB, and counts how many faults in a row have been that same distance apart. After prefetching, the last
+// page prefetched stands in for the last fault, since a process following the stride faults next just past it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prefetch.h"
+#include "pager.h"
+
+long long prefetchLoaded = 0;
+long long prefetchUsed = 0;
+long long prefetchWasted = 0;
+long long prefetchEvicted = 0;
+
+static prefetchConfig_t prefetchCfg = { PF_OFF, 0 }; // Settings in use
+
+// Function to parse prefetch spec into cfg, returns false if spec is not valid
+bool prefetchParse(const char* spec, prefetchConfig_t* cfg)
+{
+	cfg->depth = DEF_PREFETCH_DEPTH;
+
+	// Split mode from depth
+	const char* colon = strchr(spec, ':');
+	size_t nameLen = colon ? (size_t)(colon - spec) : strlen(spec);
+	if (nameLen == 3 && strncmp(spec, "off", nameLen) == 0)
+	{
+		cfg->mode = PF_OFF;
+		return colon == NULL;
+	}
+	if (nameLen == 3 && strncmp(spec, "seq", nameLen) == 0)
+		cfg->mode = PF_SEQ;
+	else if (nameLen == 6 && strncmp(spec, "stride", nameLen) == 0)
+		cfg->mode = PF_STRIDE;
+	else
+		return false;
+	if (colon == NULL)
+		return true;
+
+	char* end;
+	if (colon[1] < '0' || colon[1] > '9')
+		return false;
+	long depth = strtol(colon + 1, &end, 10);
+	cfg->depth = depth;
+	return *end == '\0' && depth >= 1 && depth <= MAX_PREFETCH_DEPTH;
+}
+
+// Function to use prefetch settings in cfg
+void prefetchInit(const prefetchConfig_t* cfg)
+{
+	prefetchCfg = *cfg;
+}
+
+// Function to check if pages are prefetched on a fault
+bool prefetchEnabled()
+{
+	return prefetchCfg.mode != PF_OFF;
+}
+
+// Function to update stride detector of process in slot with its fault on page, and fill pages with the pages to
+// prefetch along with it in the order they should be loaded. Returns amount of pages filled, which may be resident
+// already and are always inside the address space.
+int prefetchPredict(int slot, unsigned page, unsigned* pages)
+{
+	PCB* pcb = &processTable[slot];
+	long long stride = 1;
+	if (prefetchCfg.mode == PF_STRIDE)
+	{
+		// Count faults in a row the same distance apart, starting over when the distance changes
+		long long delta = (long long)page - pcb->lastFaultPage;
+		if (pcb->lastFaultPage != -1 && delta != 0 && delta == pcb->faultStride)
+			pcb->strideRun++;
+		else
+		{
+			pcb->faultStride = delta;
+			pcb->strideRun = 0;
+		}
+		pcb->lastFaultPage = page;
+
+		// Only predict once distance has repeated
+		if (pcb->strideRun == 0)
+			return 0;
+		stride = pcb->faultStride;
+	}
+
+	int count = 0;
+	long long next = page;
+	for (int i = 0; i < prefetchCfg.depth; i++)
+	{
+		next += stride;
+		if (next < 0 || next >= pageCount)
+			break;
+		pages[count++] = (unsigned)next;
+	}
+	// Next fault along the stride comes after the last page prefetched, so measure its distance from there
+	if (prefetchCfg.mode == PF_STRIDE && count > 0)
+		pcb->lastFaultPage = pages[count - 1];
+	return count;
+}
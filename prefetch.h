@@ -0,0 +1,38 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Prefetching of pages on a fault. Sequential read-ahead predicts the pages following the faulted one,
+// and the stride detector predicts pages along the distance between a process's last faults once the same distance has
+// been seen twice in a row. The pager loads predicted pages that are not resident along with the faulted page, and tags
+// their frames so the final statistics can tell how many were used before being evicted. Specs given with -F have the
+// form mode[:depth], for example stride:8.
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// Prefetch modes
+#define PF_OFF 0 // Only the faulted page is loaded
+#define PF_SEQ 1 // Pages following the faulted page are loaded
+#define PF_STRIDE 2 // Pages along a detected stride are loaded
+
+#define DEF_PREFETCH_DEPTH 4 // Default most pages prefetched on each fault
+#define MAX_PREFETCH_DEPTH 64 // Most pages that can be prefetched on each fault
+
+// Structure for prefetch settings
+typedef struct
+{
+	int mode; // One of the PF_ values
+	int depth; // Most pages prefetched on each fault
+} prefetchConfig_t;
+
+extern long long prefetchLoaded; // Pages loaded by prefetching
+extern long long prefetchUsed; // Prefetched pages referenced before they were evicted
+extern long long prefetchWasted; // Prefetched pages evicted or released without being referenced
+extern long long prefetchEvicted; // Resident pages evicted to make room for prefetched pages
+
+bool prefetchParse(const char* spec, prefetchConfig_t* cfg);
+void prefetchInit(const prefetchConfig_t* cfg);
+bool prefetchEnabled();
+int prefetchPredict(int slot, unsigned page, unsigned* pages);
+
+#endif
@@ -0,0 +1,209 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Reference stream of a simulated worker. Acts at a random time within BOUND_NS of the last act, checks every
+// TERM_CHECK_NS whether to terminate once LIFE_NS has passed, and requests an address picked by the selected generator
+// as a read or write. Generators are chosen with a spec of the form name[:param[:param]], for example zipf:0.9,
+// stride:8 or phase:16:500.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "refgen.h"
+
+// Cumulative probability of each zipf rank, shared by every stream since settings are the same for the whole run
+static std::vector<double> zipfCdf;
+
+// Function to get next 32 random bits from PCG generator
+static unsigned refRand(refState_t* st)
+{
+	unsigned long long old = st->rng;
+	st->rng = old * 6364136223846793005ULL + 1442695040888963407ULL;
+	unsigned xorshifted = ((old >> 18) ^ old) >> 27;
+	unsigned rot = old >> 59;
+	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// Function to get random number below bound
+static unsigned refBelow(refState_t* st, unsigned bound)
+{
+	return ((unsigned long long)refRand(st) * bound) >> 32;
+}
+
+// Function to get random number in [0, 1)
+static double refUnit(refState_t* st)
+{
+	return refRand(st) / 4294967296.0;
+}
+
+// Function to parse generator spec into cfg, returns false if spec is not valid
+bool refParse(const char* spec, refConfig_t* cfg)
+{
+	cfg->gen = GEN_UNIFORM;
+	cfg->zipfS = DEF_ZIPF_S;
+	cfg->stride = DEF_STRIDE;
+	cfg->wsPages = DEF_WS_PAGES;
+	cfg->phaseLen = DEF_PHASE_LEN;
+
+	// Split name from parameters
+	const char* colon = strchr(spec, ':');
+	size_t nameLen = colon ? (size_t)(colon - spec) : strlen(spec);
+	const char* params = colon ? colon + 1 : NULL;
+	char* end;
+
+	if (nameLen == 7 && strncmp(spec, "uniform", nameLen) == 0)
+		return params == NULL;
+	if (nameLen == 3 && strncmp(spec, "seq", nameLen) == 0)
+	{
+		cfg->gen = GEN_SEQ;
+		return params == NULL;
+	}
+	if (nameLen == 4 && strncmp(spec, "zipf", nameLen) == 0)
+	{
+		cfg->gen = GEN_ZIPF;
+		if (params == NULL)
+			return true;
+		cfg->zipfS = strtod(params, &end);
+		return *end == '\0' && cfg->zipfS > 0;
+	}
+	if (nameLen == 6 && strncmp(spec, "stride", nameLen) == 0)
+	{
+		cfg->gen = GEN_STRIDE;
+		if (params == NULL)
+			return true;
+		long stride = strtol(params, &end, 10);
+		cfg->stride = stride;
+		return *end == '\0' && stride > 0;
+	}
+	if (nameLen == 5 && strncmp(spec, "phase", nameLen) == 0)
+	{
+		cfg->gen = GEN_PHASE;
+		if (params == NULL)
+			return true;
+		long ws = strtol(params, &end, 10);
+		cfg->wsPages = ws;
+		if (ws <= 0 || (*end != '\0' && *end != ':'))
+			return false;
+		if (*end == '\0')
+			return true;
+		long len = strtol(end + 1, &end, 10);
+		cfg->phaseLen = len;
+		return *end == '\0' && len > 0;
+	}
+	return false;
+}
+
+// Function to finish settings for an address space of pageCount pages of pageSize bytes, building the zipf table if
+// it is needed
+void refConfigure(refConfig_t* cfg, unsigned pageSize, unsigned pageCount, unsigned writePct)
+{
+	cfg->pageSize = pageSize;
+	cfg->pageCount = pageCount;
+	cfg->writePct = writePct;
+	if (cfg->wsPages > pageCount)
+		cfg->wsPages = pageCount;
+
+	if (cfg->gen == GEN_ZIPF)
+	{
+		zipfCdf.resize(pageCount);
+		double sum = 0.0;
+		for (unsigned k = 0; k < pageCount; k++)
+		{
+			sum += 1.0 / pow(k + 1, cfg->zipfS);
+			zipfCdf[k] = sum;
+		}
+		for (unsigned k = 0; k < pageCount; k++)
+		{
+			zipfCdf[k] /= sum;
+		}
+	}
+}
+
+// Function to start reference stream at current time, with first act within bound ns
+void refInit(refState_t* st, unsigned seed, long long nowNs, const refConfig_t* cfg)
+{
+	// Spread seed over the whole state with splitmix64, so nearby pids give unrelated streams
+	unsigned long long z = seed + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	st->rng = z ^ (z >> 31);
+
+	st->cfg = cfg;
+	st->startNs = nowNs;
+	st->lastTermChk = nowNs;
+	st->cursor = refBelow(st, cfg->pageCount);
+	st->phaseBase = refBelow(st, cfg->pageCount - cfg->wsPages + 1);
+	st->phaseLeft = cfg->phaseLen;
+	st->nAct = nowNs + refBelow(st, BOUND_NS);
+}
+
+// Function to randomly generate time for next act after current time
+void refSchedule(refState_t* st, long long nowNs)
+{
+	st->nAct = nowNs + refBelow(st, BOUND_NS);
+}
+
+// Function to determine if worker should terminate, checked every time it reaches term check (250000000 ns)
+bool refCheckTerm(refState_t* st, long long nowNs)
+{
+	if (nowNs - st->lastTermChk < TERM_CHECK_NS)
+		return false;
+	st->lastTermChk = nowNs;
+
+	// Once lifetime (2 sec) is reached, randomly generate number up to 100 to determine if worker will terminate
+	if (nowNs - st->startNs >= LIFE_NS)
+		return refBelow(st, 100) < TERM_PROB;
+	return false;
+}
+
+// Function to pick next page with the selected generator
+static unsigned refPage(refState_t* st)
+{
+	const refConfig_t* cfg = st->cfg;
+	unsigned page;
+	switch (cfg->gen)
+	{
+		case GEN_ZIPF:
+		{
+			// Find first rank whose cumulative probability reaches a uniform draw
+			double u = refUnit(st);
+			unsigned lo = 0;
+			unsigned hi = cfg->pageCount - 1;
+			while (lo < hi)
+			{
+				unsigned mid = lo + (hi - lo) / 2;
+				if (zipfCdf[mid] < u)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			return lo;
+		}
+		case GEN_SEQ:
+		case GEN_STRIDE:
+			page = st->cursor;
+			st->cursor = (st->cursor + (cfg->gen == GEN_SEQ ? 1 : cfg->stride)) % cfg->pageCount;
+			return page;
+		case GEN_PHASE:
+			// Move working set somewhere else once phase is over
+			if (st->phaseLeft == 0)
+			{
+				st->phaseBase = refBelow(st, cfg->pageCount - cfg->wsPages + 1);
+				st->phaseLeft = cfg->phaseLen;
+			}
+			st->phaseLeft--;
+			return st->phaseBase + refBelow(st, cfg->wsPages);
+		default:
+			return refBelow(st, cfg->pageCount);
+	}
+}
+
+// Function to generate next request, an address in the page picked by the generator that is a write writePct
+// percent of the time
+void refNext(refState_t* st, unsigned* address, bool* isWrite)
+{
+	unsigned page = refPage(st);
+	*address = page * st->cfg->pageSize + refBelow(st, st->cfg->pageSize);
+	*isWrite = refBelow(st, 100) < st->cfg->writePct;
+}
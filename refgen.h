@@ -0,0 +1,64 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Reference stream of a simulated worker, shared by the worker program and the in-process engine of oss.
+// Holds when the worker acts next, decides whether it terminates, and generates the address and type of each request
+// with the selected generator. All randomness comes from a PCG generator kept in the state, so many streams can run
+// side by side in one process.
+
+#ifndef REFGEN_H
+#define REFGEN_H
+
+#define BOUND_NS 1000
+#define TERM_CHECK_NS 250000000
+#define LIFE_NS 2000000000
+#define TERM_PROB 40
+
+// Reference generators
+#define GEN_UNIFORM 0 // Every page equally likely
+#define GEN_ZIPF 1 // Page of rank k chosen with probability proportional to 1 / k^s, so a few pages are hot
+#define GEN_SEQ 2 // Pages scanned in order, wrapping at end of address space
+#define GEN_STRIDE 3 // Pages scanned a fixed amount of pages apart, wrapping at end of address space
+#define GEN_PHASE 4 // Uniform within a working set of contiguous pages that moves to a random place every phase
+
+#define DEF_GEN "uniform" // Generator used if none is given
+#define DEF_ZIPF_S 1.0 // Default skew of zipf generator
+#define DEF_STRIDE 4 // Default stride in pages
+#define DEF_WS_PAGES 8 // Default working set size in pages
+#define DEF_PHASE_LEN 1000 // Default references in each phase
+#define DEF_WRITE_PCT 50 // Default percent of references that are writes
+
+// Structure for generator settings, the same for every worker in a run
+typedef struct
+{
+	int gen; // One of the GEN_ values
+	double zipfS; // Skew of zipf generator
+	unsigned stride; // Pages between references of strided generator
+	unsigned wsPages; // Working set size of phase generator
+	unsigned phaseLen; // References in each phase of phase generator
+	unsigned writePct; // Percent of references that are writes
+	unsigned pageSize; // Size of a page in bytes
+	unsigned pageCount; // Pages in address space
+} refConfig_t;
+
+// Structure for state of one worker's reference stream
+typedef struct
+{
+	unsigned long long rng; // PCG random number state
+	long long startNs; // Time worker started
+	long long lastTermChk; // Time of last termination check
+	long long nAct; // Time worker will act next
+	const refConfig_t* cfg; // Generator settings
+	unsigned cursor; // Next page of sequential and strided generators
+	unsigned phaseBase; // First page of current working set
+	unsigned phaseLeft; // References left in current phase
+} refState_t;
+
+bool refParse(const char* spec, refConfig_t* cfg);
+void refConfigure(refConfig_t* cfg, unsigned pageSize, unsigned pageCount, unsigned writePct);
+void refInit(refState_t* st, unsigned seed, long long nowNs, const refConfig_t* cfg);
+void refSchedule(refState_t* st, long long nowNs);
+bool refCheckTerm(refState_t* st, long long nowNs);
+void refNext(refState_t* st, unsigned* address, bool* isWrite);
+
+#endif
@@ -0,0 +1,569 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Shard threads of the sharded pager. Each shard holds its service lock while it drains its rings and
+// completes its faults, and the coordinator takes it to attach or detach a slot or to print a snapshot, so the shard's
+// slots and frames are only ever touched by one thread at a time. Free frames are kept on one stack per home shard under
+// a separate lock, since a shard out of free frames takes one from another shard's stack while holding its own service
+// lock. A shard only lends frames while it still holds more than one of its home frames, so it can always evict one of
+// its own when no other shard has a frame to spare. Shards share words of the frame table's bitsets, so they update
+// those bits atomically. Each shard thread pins itself to a processor, allocates its own stacks and queue so they are
+// placed on that processor's memory node, and asks the kernel to move the pages of frame table fields holding only its
+// home frames to that node as well, so a shard works on local memory on a multi-socket machine.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <signal.h>
+#include <pthread.h>
+#include <limits.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "shard.h"
+#include "pager.h"
+#include "pagetable.h"
+#include "swap.h"
+#include "log.h"
+
+#define SHARD_HIT_NS 1100 // System time added for a hit, the overhead and access time the main loop adds
+#define SHARD_LOAD_NS 1000 // System time added for loading a faulted page, and again if it was a write
+#define MOVE_BATCH 64 // Most pages moved to a node by each system call
+
+// Structure for one shard
+typedef struct
+{
+	std::mutex lock; // Service lock, held while shard services requests and by coordinator to change or print it
+	std::atomic<int> wanted; // Times coordinator is waiting for service lock, shard stays out of it until 0
+	std::mutex freeLock; // Guards free stack and home count, also taken by other shards borrowing a frame
+	int* freeStack; // Free frames whose home is this shard
+	int freeTop; // Amount of frames on free stack
+	int home; // Frames whose home is this shard that are free or loaded by it, not lent to others
+	frameList_t lru; // Frames loaded by this shard, most recently used first
+	waitQueue_t waitQueue; // Slots of this shard waiting on page faults, earliest completion on top
+	int* slots; // PCB slots served by this shard
+	int slotCount; // Amount of PCB slots served by this shard
+	int cursor; // Index in slots to check first on the next pass, so every worker gets a turn
+	int* grantSlots; // Slots granted during the current pass
+	int grantCount; // Amount of grants in the current pass
+	std::atomic<long long> passes; // Passes shard has finished
+	std::atomic<int> waiting; // Size of wait queue at end of last pass
+	std::atomic<long long> nextDoneNs; // Earliest fault completion at end of last pass, LLONG_MAX if none
+	std::atomic<long long> refs; // References serviced
+	std::atomic<long long> faults; // Page faults serviced
+	long long borrowed; // Frames taken from other shards
+	long long evicted; // Frames evicted from its own LRU list
+	arena_t arena; // Arena the shard's own tables are allocated from, by its own thread
+	int node; // Memory node of the processor the shard runs on
+	std::thread thread; // Thread servicing shard
+} shard_t;
+
+int shardCount = 0;
+
+static shard_t* shards = NULL; // Every shard
+static arena_t shardArena = { NULL, 0 }; // Arena the table of attached slots is allocated from
+static ringSlot_t* shardRings = NULL; // Ring of each PCB slot
+static bool* shardActive = NULL; // True for slots attached to their shard, written under its service lock
+static int shardBatch = 1; // Most requests drained by a shard in each pass
+static std::atomic<bool> shardStopping(false); // True once shards should exit
+static std::atomic<int> shardReady(0); // Shards that have finished setting up their tables
+
+// Function to find home shard of frame, every shard being home to an equal range of frames
+static inline int frameHome(int frame)
+{
+	return (int)((long long)frame * shardCount / frameNum);
+}
+
+// Function to find first frame whose home is shard with id
+static inline int homeStart(int id)
+{
+	return (int)(((long long)id * frameNum + shardCount - 1) / shardCount);
+}
+
+// Function to move the whole pages in bytes of memory at start to node, leaving pages shared with memory of other shards
+// where they are. Errors are ignored, since the kernel may not support NUMA or the memory may already be there.
+static void moveToNode(const void* start, size_t bytes, int node)
+{
+	uintptr_t pageBytes = sysconf(_SC_PAGESIZE);
+	uintptr_t first = ((uintptr_t)start + pageBytes - 1) & ~(pageBytes - 1);
+	uintptr_t last = ((uintptr_t)start + bytes) & ~(pageBytes - 1);
+	void* pages[MOVE_BATCH];
+	int nodes[MOVE_BATCH];
+	int status[MOVE_BATCH];
+	while (first < last)
+	{
+		int n = 0;
+		for (; n < MOVE_BATCH && first < last; n++, first += pageBytes)
+		{
+			pages[n] = (void*)first;
+			nodes[n] = node;
+		}
+		syscall(SYS_move_pages, 0, n, pages, nodes, status, MPOL_MF_MOVE);
+	}
+}
+
+// Function to pin shard with id to one of the processors oss may run on, and set up its stacks, queue and home frames
+// from its own thread so their memory is placed on that processor's node
+static void shardSetup(int id)
+{
+	shard_t* sh = &shards[id];
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 1)
+	{
+		// Spread shards over allowed processors in order
+		int nth = id % CPU_COUNT(&allowed);
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if (!CPU_ISSET(cpu, &allowed) || nth-- > 0)
+				continue;
+			cpu_set_t one;
+			CPU_ZERO(&one);
+			CPU_SET(cpu, &one);
+			sched_setaffinity(0, sizeof(one), &one);
+			break;
+		}
+	}
+	unsigned cpu = 0, node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+		sh->node = node;
+
+	int start = homeStart(id);
+	int end = homeStart(id + 1);
+	sh->freeStack = arenaArray<int>(&sh->arena, end - start);
+	sh->slots = arenaArray<int>(&sh->arena, sh->slotCount);
+	sh->grantSlots = arenaArray<int>(&sh->arena, sh->slotCount);
+	for (int i = 0; i < sh->slotCount; i++)
+	{
+		sh->slots[i] = id + i * shardCount;
+	}
+	// Every slot of the shard waits on at most one fault
+	std::vector<waitEntry_t> waitStore;
+	waitStore.reserve(sh->slotCount);
+	sh->waitQueue = waitQueue_t(std::greater<waitEntry_t>(), std::move(waitStore));
+
+	// Move frame table fields of home frames to this node, then push them highest first so the lowest is used first
+	int count = end - start;
+	moveToNode(frameTable.lastRefNs + start, count * sizeof(long long), sh->node);
+	moveToNode(frameTable.ownerPid + start, count * sizeof(pid_t), sh->node);
+	moveToNode(frameTable.ownerSlot + start, count * sizeof(int), sh->node);
+	moveToNode(frameTable.pageNum + start, count * sizeof(int), sh->node);
+	moveToNode(frameTable.lruPrev + start, count * sizeof(int), sh->node);
+	moveToNode(frameTable.lruNext + start, count * sizeof(int), sh->node);
+	moveToNode(frameTable.ownPrev + start, count * sizeof(int), sh->node);
+	moveToNode(frameTable.ownNext + start, count * sizeof(int), sh->node);
+	for (int i = end - 1; i >= start; i--)
+	{
+		sh->freeStack[sh->freeTop++] = i;
+	}
+	sh->home = count;
+	shardReady.fetch_add(1);
+}
+
+// Function to update a bit of the frame table, whose word other shards may be updating at the same time
+static inline void bitShared(unsigned long long* set, int i, bool value)
+{
+	if (value)
+		__atomic_fetch_or(&set[i >> 6], 1ULL << (i & 63), __ATOMIC_RELAXED);
+	else
+		__atomic_fetch_and(&set[i >> 6], ~(1ULL << (i & 63)), __ATOMIC_RELAXED);
+}
+
+// Function to add one to a counter only its shard writes, so others can read it while it runs
+static inline void countUp(std::atomic<long long>* counter)
+{
+	counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Function to take a free frame from the shard with id, or borrow one from the next shard able to lend one, returns -1
+// if no shard has a frame to spare
+static int takeFree(int id)
+{
+	for (int i = 0; i < shardCount; i++)
+	{
+		shard_t* other = &shards[(id + i) % shardCount];
+		std::lock_guard<std::mutex> guard(other->freeLock);
+		if (other->freeTop == 0)
+			continue;
+		if (i == 0)
+			return other->freeStack[--other->freeTop];
+		if (other->home > 1)
+		{
+			other->home--;
+			shards[id].borrowed++;
+			return other->freeStack[--other->freeTop];
+		}
+	}
+	return -1;
+}
+
+// Function to return a released frame to the free stack of its home shard
+static void giveFree(int frame, int id)
+{
+	int homeId = frameHome(frame);
+	shard_t* homeShard = &shards[homeId];
+	std::lock_guard<std::mutex> guard(homeShard->freeLock);
+	homeShard->freeStack[homeShard->freeTop++] = frame;
+	if (homeId != id)
+		homeShard->home++;
+}
+
+// Function to service a request from worker in slot. A hit is granted at the end of the pass, a page fault puts the
+// worker in the shard's wait queue.
+static void shardRequest(shard_t* sh, int slot, const msgbuffer* msg)
+{
+	countUp(&sh->refs);
+
+	unsigned page = msg->address / pageSize;
+	if (page >= (unsigned)pageCount)
+	{
+		fprintf(stderr, "ERROR! OSS: bad address %u. Page %u out of range.\n", msg->address, page);
+		exit(1);
+	}
+
+	long long nowNs = clockNow();
+	logPrintf(LOG_REFS, "oss: P%d requesting %s of address %u at time %u:%09u\n", slot, msg->isWrite ? "write" : "read",
+		msg->address, clockSec(nowNs), clockNano(nowNs));
+
+	int frame = ptGet(slot, page);
+	if (frame != -1)
+	{
+		nowNs = clockAdd(SHARD_HIT_NS);
+
+		// Update frame table and move frame to front of shard's LRU list
+		frameChanged(frame);
+		frameTable.lastRefNs[frame] = nowNs;
+		bitShared(frameTable.refBit, frame, true);
+		if (msg->isWrite)
+			bitShared(frameTable.dirty, frame, true);
+		listUnlink(&sh->lru, frame);
+		listPushFront(&sh->lru, frame);
+
+		sh->grantSlots[sh->grantCount++] = slot;
+		if (msg->isWrite)
+			logPrintf(LOG_REFS, "oss: Address %u in frame %d, writing data to frame at time %u:%09u\n", msg->address, frame, clockSec(nowNs), clockNano(nowNs));
+		else
+			logPrintf(LOG_REFS, "oss: Address %u in frame %d, giving data to P%d at time %u:%09u\n", msg->address, frame, slot, clockSec(nowNs), clockNano(nowNs));
+		return;
+	}
+
+	countUp(&sh->faults);
+	logPrintf(LOG_REFS, "oss: Address %u is not in a frame, pagefault\n", msg->address);
+
+	// Mark process as waiting until its fixed fault latency has passed
+	processTable[slot].waiting = true;
+	processTable[slot].waitPage = page;
+	processTable[slot].waitAddress = msg->address;
+	processTable[slot].waitIsWrite = msg->isWrite;
+	processTable[slot].waitSec = clockSec(nowNs);
+	processTable[slot].waitNano = clockNano(nowNs);
+	long long doneNs = nowNs + FAULT_READ_NS;
+	if (msg->isWrite)
+		doneNs += FAULT_WRITE_NS;
+	sh->waitQueue.push(waitEntry_t(doneNs, slot));
+}
+
+// Function to load the page worker in slot is waiting on into a free frame, a borrowed frame, or the least recently
+// used frame of the shard, and grant its request at the end of the pass
+static void shardComplete(shard_t* sh, int id, int slot)
+{
+	unsigned page = processTable[slot].waitPage;
+	bool isWrite = processTable[slot].waitIsWrite;
+
+	int frame = takeFree(id);
+	if (frame < 0)
+	{
+		// Evict least recently used frame, always one of this shard's slots' pages
+		frame = sh->lru.tail;
+		listUnlink(&sh->lru, frame);
+		int owner = frameTable.ownerSlot[frame];
+		ptClear(owner, frameTable.pageNum[frame]);
+		residentUnlink(owner, frame);
+		sh->evicted++;
+		logPrintf(LOG_REFS, "oss: Clearing frame %d and swapping in p%d page %u\n", frame, slot, page);
+	}
+
+	frameChanged(frame);
+	bitShared(frameTable.occupied, frame, true);
+	bitShared(frameTable.dirty, frame, isWrite);
+	bitShared(frameTable.refBit, frame, true);
+	frameTable.ownerPid[frame] = processTable[slot].pid;
+	frameTable.ownerSlot[frame] = slot;
+	frameTable.pageNum[frame] = page;
+	residentPush(slot, frame);
+	ptSet(slot, page, frame);
+	listPushFront(&sh->lru, frame);
+	processTable[slot].waiting = false;
+
+	long long nowNs = clockAdd(isWrite ? 2 * SHARD_LOAD_NS : SHARD_LOAD_NS);
+	frameTable.lastRefNs[frame] = nowNs;
+	sh->grantSlots[sh->grantCount++] = slot;
+
+	if (isWrite)
+		logPrintf(LOG_REFS, "oss: Dirty bit of frame %d set, adding additional time to the clock\n", frame);
+	logPrintf(LOG_REFS, "oss: Indicating to P%d that %s has happened to the address %u\n", slot, isWrite ? "write" : "read",
+		page * pageSize);
+}
+
+// Function run by each shard thread, servicing its slots in passes until stopped
+static void shardMain(int id)
+{
+	shardSetup(id);
+	shard_t* sh = &shards[id];
+	msgbuffer msg;
+	msgbuffer reply;
+	reply.granted = true;
+	reply.terminating = false;
+
+	while (!shardStopping.load(std::memory_order_relaxed))
+	{
+		// Let coordinator have the service lock if it is waiting for it
+		while (sh->wanted.load())
+			sched_yield();
+
+		sh->lock.lock();
+		// Drain ring of every attached slot once, up to batch cap
+		int drained = 0;
+		for (int i = 0; i < sh->slotCount && drained < shardBatch; i++)
+		{
+			int slot = sh->slots[(sh->cursor + i) % sh->slotCount];
+			if (shardActive[slot] && ringPop(&shardRings[slot].request, &msg))
+			{
+				shardRequest(sh, slot, &msg);
+				drained++;
+			}
+		}
+		sh->cursor = (sh->cursor + 1) % sh->slotCount;
+
+		// Complete every fault whose latency has passed, earliest first
+		long long nowNs = clockNow();
+		while (!sh->waitQueue.empty() && sh->waitQueue.top().first <= nowNs)
+		{
+			int slot = sh->waitQueue.top().second;
+			sh->waitQueue.pop();
+			if (shardActive[slot] && processTable[slot].waiting)
+				shardComplete(sh, id, slot);
+		}
+		sh->waiting.store(sh->waitQueue.size());
+		sh->nextDoneNs.store(sh->waitQueue.empty() ? LLONG_MAX : sh->waitQueue.top().first);
+
+		// Publish every reply, then wake only the workers that went to sleep
+		reply.actNs = clockNow();
+		for (int i = 0; i < sh->grantCount; i++)
+		{
+			int slot = sh->grantSlots[i];
+			reply.mtype = processTable[slot].pid;
+			reply.pid = processTable[slot].pid;
+			ringPublish(&shardRings[slot], &reply);
+		}
+		for (int i = 0; i < sh->grantCount; i++)
+		{
+			ringWake(&shardRings[sh->grantSlots[i]]);
+		}
+		int granted = sh->grantCount;
+		sh->grantCount = 0;
+		sh->lock.unlock();
+
+		sh->passes.fetch_add(1);
+		// Give up the processor if the pass did no work, since workers may be waiting to run
+		if (drained == 0 && granted == 0)
+			sched_yield();
+	}
+}
+
+// Function to split frames and PCB slots across count shards serving the given rings, and start a thread for each,
+// returning once every shard has set up its tables. There must be at least as many frames as shards, so every shard is
+// home to one.
+void shardStart(int count, ringSlot_t* rings, int batch)
+{
+	shardCount = count;
+	shardRings = rings;
+	shardBatch = batch;
+	shardStopping.store(false);
+	shardReady.store(0);
+	// Tables of the last run are kept after shardStop so its totals can still be read, and are freed here instead
+	delete[] shards;
+	arenaRelease(&shardArena);
+	shards = new shard_t[count];
+	shardActive = arenaArray<bool>(&shardArena, maxProc);
+
+	// The frames are handed out by the shards, so none are left on the pager's own free stack
+	freeTop = 0;
+	for (int k = 0; k < count; k++)
+	{
+		shard_t* sh = &shards[k];
+		sh->wanted.store(0);
+		sh->freeTop = 0;
+		sh->home = 0;
+		listInit(&sh->lru);
+		sh->slotCount = (maxProc - k + count - 1) / count;
+		sh->cursor = 0;
+		sh->grantCount = 0;
+		sh->passes.store(0);
+		sh->waiting.store(0);
+		sh->nextDoneNs.store(LLONG_MAX);
+		sh->refs.store(0);
+		sh->faults.store(0);
+		sh->borrowed = 0;
+		sh->evicted = 0;
+		sh->arena.head = NULL;
+		sh->arena.bytes = 0;
+		sh->node = 0;
+	}
+
+	// Block signals in shards so alarm is always handled by the coordinator
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	for (int k = 0; k < count; k++)
+	{
+		shards[k].thread = std::thread(shardMain, k);
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+	// Shards lend frames to each other, so wait until all of them hold their home frames
+	while (shardReady.load() < count)
+		sched_yield();
+}
+
+// Function to stop every shard thread and wait for it to exit, leaving its counts for the final statistics
+void shardStop()
+{
+	shardStopping.store(true);
+	for (int k = 0; k < shardCount; k++)
+	{
+		shards[k].thread.join();
+		arenaRelease(&shards[k].arena);
+	}
+}
+
+// Function to take service lock of shard, keeping its thread from starting another pass until it is given back
+static void shardLock(shard_t* sh)
+{
+	sh->wanted.fetch_add(1);
+	sh->lock.lock();
+	sh->wanted.fetch_sub(1);
+}
+
+// Function for coordinator to hand newly spawned worker in slot to its shard, which starts polling its ring
+void shardAttach(int slot)
+{
+	shard_t* sh = &shards[slot % shardCount];
+	shardLock(sh);
+	shardActive[slot] = true;
+	sh->lock.unlock();
+}
+
+// Function for coordinator to take finished worker in slot back from its shard, clearing its page table and returning
+// each of its frames to its home shard
+void shardDetach(int slot)
+{
+	int id = slot % shardCount;
+	shard_t* sh = &shards[id];
+	shardLock(sh);
+	shardActive[slot] = false;
+	processTable[slot].waiting = false;
+	int frame = processTable[slot].residentHead;
+	while (frame != -1)
+	{
+		int next = frameTable.ownNext[frame];
+		listUnlink(&sh->lru, frame);
+		ptClear(slot, frameTable.pageNum[frame]);
+		frameChanged(frame);
+		bitShared(frameTable.occupied, frame, false);
+		bitShared(frameTable.dirty, frame, false);
+		bitShared(frameTable.refBit, frame, false);
+		frameTable.ownerPid[frame] = -1;
+		frameTable.ownerSlot[frame] = -1;
+		frameTable.pageNum[frame] = -1;
+		frameTable.ownPrev[frame] = -1;
+		frameTable.ownNext[frame] = -1;
+		giveFree(frame, id);
+		frame = next;
+	}
+	processTable[slot].residentHead = -1;
+	processTable[slot].residentCount = 0;
+	sh->lock.unlock();
+}
+
+// Function for coordinator to take the service lock of every shard, in order, so tables can be read while no shard
+// is changing them
+void shardLockAll()
+{
+	for (int k = 0; k < shardCount; k++)
+	{
+		shardLock(&shards[k]);
+	}
+}
+
+// Function to give back every service lock taken by shardLockAll
+void shardUnlockAll()
+{
+	for (int k = shardCount - 1; k >= 0; k--)
+	{
+		shards[k].lock.unlock();
+	}
+}
+
+// Function for coordinator to wait until every shard has finished a pass since the last call, so it steps the clock
+// once for each pass made by the slowest shard, the same as once per iteration of the main loop
+void shardWaitPass()
+{
+	static long long seen[MAX_SHARDS];
+	for (int k = 0; k < shardCount; k++)
+	{
+		while (shards[k].passes.load() == seen[k])
+			sched_yield();
+		seen[k] = shards[k].passes.load();
+	}
+}
+
+// Function to find amount of workers waiting on page faults in every shard, as of each shard's last pass
+int shardWaiting()
+{
+	int count = 0;
+	for (int k = 0; k < shardCount; k++)
+	{
+		count += shards[k].waiting.load();
+	}
+	return count;
+}
+
+// Function to find earliest fault completion in every shard as of its last pass, LLONG_MAX if none are waiting
+long long shardNextDoneNs()
+{
+	long long next = LLONG_MAX;
+	for (int k = 0; k < shardCount; k++)
+	{
+		long long ns = shards[k].nextDoneNs.load();
+		if (ns < next)
+			next = ns;
+	}
+	return next;
+}
+
+// Function to add up references and page faults serviced by every shard
+void shardTotals(long long* refs, long long* faults)
+{
+	*refs = 0;
+	*faults = 0;
+	for (int k = 0; k < shardCount; k++)
+	{
+		*refs += shards[k].refs.load();
+		*faults += shards[k].faults.load();
+	}
+}
+
+// Function to print what each shard serviced once every shard has stopped
+void shardPrintStats()
+{
+	for (int k = 0; k < shardCount; k++)
+	{
+		shard_t* sh = &shards[k];
+		logPrintf(LOG_STATS, "Shard %d on node %d: %lld references, %lld page faults, %lld frames borrowed, %lld evictions, %d home frames\n",
+			k, sh->node, sh->refs.load(), sh->faults.load(), sh->borrowed, sh->evicted, sh->home);
+	}
+}
@@ -0,0 +1,32 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Sharded pager, where requests from ring transport workers are serviced by several threads instead of
+// the main loop of oss. Shard k serves the PCB slots whose index is k modulo the amount of shards and is the home of an
+// equal range of the frame table. Each shard polls the rings of its own slots, keeps its own wait queue of faults and
+// its own LRU list of the frames it has loaded, so shards only meet when one runs out of free frames and borrows a free
+// frame from another. A borrowed frame goes back to its home shard once the process using it terminates. The main
+// thread of oss is left as coordinator, stepping the clock, spawning and reaping workers and printing the tables.
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "transport.h"
+
+#define MAX_SHARDS 64 // Most shards that can be started
+
+extern int shardCount; // Amount of shards running, 0 if requests are serviced by the main loop
+
+void shardStart(int count, ringSlot_t* rings, int batch);
+void shardStop();
+void shardAttach(int slot);
+void shardDetach(int slot);
+void shardLockAll();
+void shardUnlockAll();
+void shardWaitPass();
+int shardWaiting();
+long long shardNextDoneNs();
+void shardTotals(long long* refs, long long* faults);
+void shardPrintStats();
+
+#endif
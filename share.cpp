@@ -0,0 +1,167 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Shared page bookkeeping. Reverse mapping entries of every shared page come from one array with room for
+// every PCB slot to map every shared page, linked into a list per page and onto a free list when they are removed.
+// Which shared pages each process has made private is kept as a bitset per PCB slot.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "share.h"
+#include "pager.h"
+#include "pagetable.h"
+#include "tlb.h"
+
+int sharedPages = 0;
+long long shareMaps = 0;
+long long shareSplits = 0;
+long long shareUnmaps = 0;
+int shareSaved = 0;
+int sharePeakSaved = 0;
+
+static arena_t shareArena = { NULL, 0 }; // Arena every table of shared pages is allocated from
+static int* shareFrames = NULL; // Frame holding each shared page, -1 if it is not resident
+static int* shareCount = NULL; // Amount of PCB slots mapping each shared page
+static int* rmapHead = NULL; // First reverse mapping entry of each shared page, -1 if none
+static int* rmapSlot = NULL; // PCB slot of each reverse mapping entry
+static int* rmapNext = NULL; // Next entry in the same page's list or in the free list, -1 if last
+static int rmapFree = -1; // First unused reverse mapping entry
+static unsigned long long* sharePrivateBits = NULL; // Bit set for each shared page each slot has written
+static int shareWords = 0; // Words in each slot's bitset
+
+// Function to parse amount of shared pages from spec, returns false if spec is not valid
+bool shareParse(const char* spec, int* pages)
+{
+	char* end;
+	if (*spec < '0' || *spec > '9')
+		return false;
+	long count = strtol(spec, &end, 10);
+	*pages = count;
+	return *end == '\0' && count >= 1 && count <= 1000000;
+}
+
+// Function to share the first pages pages of every address space, called after pagerInit with every frame free
+void shareInit(int pages)
+{
+	arenaRelease(&shareArena);
+	sharedPages = pages < pageCount ? pages : pageCount;
+	shareMaps = 0;
+	shareSplits = 0;
+	shareUnmaps = 0;
+	shareSaved = 0;
+	sharePeakSaved = 0;
+	rmapFree = -1;
+	if (sharedPages == 0)
+		return;
+
+	shareFrames = arenaArray<int>(&shareArena, sharedPages);
+	shareCount = arenaArray<int>(&shareArena, sharedPages);
+	rmapHead = arenaArray<int>(&shareArena, sharedPages);
+	size_t entries = (size_t)maxProc * sharedPages;
+	rmapSlot = arenaArray<int>(&shareArena, entries);
+	rmapNext = arenaArray<int>(&shareArena, entries);
+	shareWords = (sharedPages + 63) / 64;
+	sharePrivateBits = arenaArray<unsigned long long>(&shareArena, (size_t)maxProc * shareWords);
+	for (int i = 0; i < sharedPages; i++)
+	{
+		shareFrames[i] = -1;
+		rmapHead[i] = -1;
+	}
+	// Chain every entry onto the free list, lowest first
+	for (size_t i = 0; i < entries; i++)
+	{
+		rmapNext[i] = i + 1 < entries ? (int)(i + 1) : -1;
+	}
+	rmapFree = 0;
+}
+
+// Function to check if page of process in slot is shared, being in the shared region and not yet written by the process
+bool shareIsShared(int slot, unsigned page)
+{
+	return page < (unsigned)sharedPages && !bitTest(&sharePrivateBits[(size_t)slot * shareWords], page);
+}
+
+// Function to get frame holding shared page, -1 if it is not resident
+int shareFrame(unsigned page)
+{
+	return shareFrames[page];
+}
+
+// Function to record that shared page was loaded into frame for process in slot, its first sharer
+void shareLoaded(int slot, unsigned page, int frame)
+{
+	shareFrames[page] = frame;
+	shareMap(slot, page);
+}
+
+// Function to add process in slot to the sharers of resident shared page
+void shareMap(int slot, unsigned page)
+{
+	int entry = rmapFree;
+	rmapFree = rmapNext[entry];
+	rmapSlot[entry] = slot;
+	rmapNext[entry] = rmapHead[page];
+	rmapHead[page] = entry;
+	if (shareCount[page]++ > 0)
+	{
+		shareSaved++;
+		if (shareSaved > sharePeakSaved)
+			sharePeakSaved = shareSaved;
+	}
+}
+
+// Function to remove process in slot from the sharers of shared page, returns amount of sharers left. Once none are
+// left the page is no longer resident, and the caller frees its frame.
+int shareUnmap(int slot, unsigned page)
+{
+	int* link = &rmapHead[page];
+	while (*link != -1 && rmapSlot[*link] != slot)
+	{
+		link = &rmapNext[*link];
+	}
+	int entry = *link;
+	*link = rmapNext[entry];
+	rmapNext[entry] = rmapFree;
+	rmapFree = entry;
+	if (--shareCount[page] > 0)
+		shareSaved--;
+	else
+		shareFrames[page] = -1;
+	return shareCount[page];
+}
+
+// Function to clear shared page from the page table and TLB of every process mapping it, as its frame is evicted.
+// Returns amount of sharers it was cleared from.
+int shareUnmapAll(unsigned page)
+{
+	int count = shareCount[page];
+	int entry = rmapHead[page];
+	while (entry != -1)
+	{
+		int next = rmapNext[entry];
+		ptClear(rmapSlot[entry], page);
+		tlbInvalidate(rmapSlot[entry], page);
+		rmapNext[entry] = rmapFree;
+		rmapFree = entry;
+		entry = next;
+	}
+	rmapHead[page] = -1;
+	shareSaved -= count - 1;
+	shareCount[page] = 0;
+	shareFrames[page] = -1;
+	shareUnmaps += count;
+	return count;
+}
+
+// Function to make shared page private to process in slot, after its first write
+void sharePrivate(int slot, unsigned page)
+{
+	bitAssign(&sharePrivateBits[(size_t)slot * shareWords], page, true);
+}
+
+// Function to forget which shared pages terminated process in slot wrote, once it no longer maps any of them
+void shareRelease(int slot)
+{
+	memset(&sharePrivateBits[(size_t)slot * shareWords], 0, shareWords * sizeof(unsigned long long));
+}
@@ -0,0 +1,35 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Shared pages with copy-on-write. The first sharedPages pages of every process's address space stand for
+// memory every process maps alike, such as shared libraries or the image a process was forked from, so while resident
+// each of them is held by one frame that every process referencing it maps. Each such frame keeps a reverse mapping
+// list of the PCB slots mapping it, so evicting it can clear every sharer's page table entry. A process's first write
+// to a shared page gives it a private copy, and the page stays private to the process from then on. Shared frames are
+// owned by SHARED_PID and are on no process's resident list. Specs given with -C are the amount of shared pages.
+
+#ifndef SHARE_H
+#define SHARE_H
+
+#define SHARED_PID 0 // Owner pid of frames holding shared pages
+#define SHARE_COPY_NS 2000 // System time to copy a shared page into a process's private frame
+
+extern int sharedPages; // Amount of shared pages at the start of every address space, 0 if none
+extern long long shareMaps; // References that mapped a shared page already resident instead of faulting
+extern long long shareSplits; // Copy-on-write splits of shared pages by a first write
+extern long long shareUnmaps; // Page table entries cleared by evicting shared frames
+extern int shareSaved; // Frames saved by sharing, one less than the sharers of each resident shared page
+extern int sharePeakSaved; // Most frames saved by sharing at once
+
+bool shareParse(const char* spec, int* pages);
+void shareInit(int pages);
+bool shareIsShared(int slot, unsigned page);
+int shareFrame(unsigned page);
+void shareLoaded(int slot, unsigned page, int frame);
+void shareMap(int slot, unsigned page);
+int shareUnmap(int slot, unsigned page);
+int shareUnmapAll(unsigned page);
+void sharePrivate(int slot, unsigned page);
+void shareRelease(int slot);
+
+#endif
@@ -0,0 +1,54 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Simulated system clock shared by oss and worker. The clock is a single count of nanoseconds in shared
+// memory, so it is advanced with one atomic add and read with one load, and a reader can never see the seconds of one
+// time with the nanoseconds of another. Seconds and nanoseconds are only split apart for printing.
+
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <atomic>
+
+#define NS_PER_SEC 1000000000LL
+
+// Structure held in the clock shared memory segment
+typedef struct
+{
+	std::atomic<long long> ns; // System time in ns
+} simClock_t;
+
+static_assert(std::atomic<long long>::is_always_lock_free, "clock must be lock free to live in shared memory");
+
+extern simClock_t* simClock; // Attached clock segment, defined by each program
+
+// Function to read system time in ns. No other data is published through the clock, so loads need no ordering.
+static inline long long clockNow()
+{
+	return simClock->ns.load(std::memory_order_relaxed);
+}
+
+// Function to advance system time by ns, returns the new time
+static inline long long clockAdd(long long ns)
+{
+	return simClock->ns.fetch_add(ns, std::memory_order_relaxed) + ns;
+}
+
+// Function to set system time to ns
+static inline void clockSet(long long ns)
+{
+	simClock->ns.store(ns, std::memory_order_relaxed);
+}
+
+// Functions to split a time in ns into seconds and nanoseconds for printing
+static inline unsigned clockSec(long long ns)
+{
+	return ns / NS_PER_SEC;
+}
+
+static inline unsigned clockNano(long long ns)
+{
+	return ns % NS_PER_SEC;
+}
+
+#endif
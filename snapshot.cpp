@@ -0,0 +1,247 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Printing of only what changed in the tables. The copy of the tables as last printed is kept in the
+// layout of a snapshot in SNAP_FILE, so a full snapshot is a single copy of it into a write buffer. While the writer
+// thread writes one buffer, the next snapshot is copied into the other, and the writer only has to be waited for if it
+// is still writing the snapshot before last.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <thread>
+#include "snapshot.h"
+#include "pager.h"
+#include "pagetable.h"
+#include "log.h"
+
+long long snapWritten = 0;
+long long snapBytes = 0;
+
+// Structure for the parts of a snapshot buffer
+typedef struct
+{
+	snapHeader_t* header; // Header at start of buffer
+	unsigned long long* occupied; // Occupied bit of every frame
+	unsigned long long* dirty; // Dirty bit of every frame
+	long long* lastRefNs; // Last access time of every frame
+	int* ownerSlot; // Owner PCB slot of every frame, -1 if free
+	int* pageNum; // Page in every frame, -1 if free
+	int* pid; // Pid in every PCB slot, -1 if unoccupied
+} snapView_t;
+
+static snapConfig_t snapCfg = { false, 0 }; // Settings in use
+static arena_t snapArena = { NULL, 0 }; // Arena the copy of the tables and both write buffers are allocated from
+static char* snapLast = NULL; // Tables as of the last print, in snapshot layout
+static snapView_t snapView; // Parts of snapLast
+static char* snapBuf[2] = { NULL, NULL }; // Buffers full snapshots are written from, taking turns
+static int snapNext = 0; // Buffer the next full snapshot is copied into
+static long long snapLastNs = 0; // System time of the last print
+static int snapTicks = 0; // Prints since the last full snapshot
+static bool* snapRestarted = NULL; // True for each PCB slot whose process started or finished since the last print
+static FILE* snapFile = NULL; // File full snapshots are written to
+static std::thread snapWriter; // Thread writing the last full snapshot
+static pid_t snapPid = -1; // Process writer thread belongs to, forked children must not touch it
+
+// Function to parse snapshot spec into cfg, returns false if spec is not valid
+bool snapParse(const char* spec, snapConfig_t* cfg)
+{
+	if (strncmp(spec, "delta", 5) != 0)
+		return false;
+	cfg->on = true;
+	cfg->fullEvery = DEF_SNAP_EVERY;
+	if (spec[5] == '\0')
+		return true;
+	if (spec[5] != ':' || spec[6] < '0' || spec[6] > '9')
+		return false;
+	char* end;
+	long every = strtol(spec + 6, &end, 10);
+	cfg->fullEvery = every;
+	return *end == '\0' && every <= 1000000;
+}
+
+// Function to find parts of a snapshot buffer
+static void snapLayout(char* buf, snapView_t* view)
+{
+	size_t words = (frameNum + 63) / 64;
+	view->header = (snapHeader_t*)buf;
+	view->occupied = (unsigned long long*)(buf + sizeof(snapHeader_t));
+	view->dirty = view->occupied + words;
+	view->lastRefNs = (long long*)(view->dirty + words);
+	view->ownerSlot = (int*)(view->lastRefNs + frameNum);
+	view->pageNum = view->ownerSlot + frameNum;
+	view->pid = view->pageNum + frameNum;
+}
+
+// Function to wait for writer thread and close snapshot file, registered to run when oss exits
+static void snapClose()
+{
+	if (snapPid != getpid())
+		return;
+	if (snapWriter.joinable())
+		snapWriter.join();
+	if (snapFile != NULL)
+		fclose(snapFile);
+	snapFile = NULL;
+	snapPid = -1;
+}
+
+// Function to start printing only changes with settings in cfg. Called after pagerInit, while every frame is free and
+// no process has started, so the copy of the tables starts out empty as well.
+void snapInit(const snapConfig_t* cfg)
+{
+	snapCfg = *cfg;
+	frameChangedRanges = NULL;
+	snapWritten = 0;
+	if (!snapCfg.on)
+		return;
+
+	size_t words = (frameNum + 63) / 64;
+	snapBytes = sizeof(snapHeader_t) + 2 * words * sizeof(unsigned long long) + frameNum * sizeof(long long) + 2 * (size_t)frameNum * sizeof(int) + maxProc * sizeof(int);
+	arenaRelease(&snapArena);
+	snapLast = arenaArray<char>(&snapArena, snapBytes);
+	snapLayout(snapLast, &snapView);
+	memset(snapView.ownerSlot, 0xff, 2 * (size_t)frameNum * sizeof(int) + maxProc * sizeof(int));
+	snapView.header->magic = SNAP_MAGIC;
+	snapView.header->version = SNAP_VERSION;
+	snapView.header->frameNum = frameNum;
+	snapView.header->maxProc = maxProc;
+	snapView.header->pageCount = pageCount;
+	snapView.header->pageSize = pageSize;
+	snapRestarted = arenaArray<bool>(&snapArena, maxProc);
+	frameChangedRanges = arenaArray<unsigned long long>(&snapArena, (words + 63) / 64);
+	snapLastNs = clockNow();
+	snapTicks = 0;
+	snapNext = 0;
+	if (snapCfg.fullEvery == 0)
+		return;
+
+	snapBuf[0] = arenaArray<char>(&snapArena, snapBytes);
+	snapBuf[1] = arenaArray<char>(&snapArena, snapBytes);
+	snapFile = fopen(SNAP_FILE, "wb");
+	if (snapFile == NULL)
+	{
+		perror("fopen snapshot");
+		exit(1);
+	}
+	snapPid = getpid();
+	atexit(snapClose);
+}
+
+// Function to check if only changes are printed
+bool snapEnabled()
+{
+	return snapCfg.on;
+}
+
+// Function run by writer thread, writing full snapshot in buf to snapshot file
+static void snapWriterMain(const char* buf)
+{
+	if (fwrite(buf, 1, snapBytes, snapFile) != (size_t)snapBytes || fflush(snapFile) != 0)
+		perror("fwrite snapshot");
+}
+
+// Function to copy tables as of the last print into the next write buffer and start writing it
+static void snapWrite()
+{
+	// Writer may still be on the other buffer, but is done with this one once it has been joined
+	if (snapWriter.joinable())
+		snapWriter.join();
+	char* buf = snapBuf[snapNext];
+	memcpy(buf, snapLast, snapBytes);
+	snapNext ^= 1;
+	snapWritten++;
+
+	// Block signals in writer so alarm is always handled by the main thread
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	snapWriter = std::thread(snapWriterMain, buf);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+// Function to print page table entries that changed along with frame, whose page used to be oldPage of oldSlot
+static void snapPrintMapping(int frame, int oldSlot, int oldPage)
+{
+	// Pages of processes that started or finished are covered by their process table line
+	if (oldSlot != -1 && !snapRestarted[oldSlot] && ptGet(oldSlot, oldPage) == -1)
+		logPrintf(LOG_TABLES, "P%d page %d: not resident\n", oldSlot, oldPage);
+	int slot = frameTable.ownerSlot[frame];
+	if (slot != -1 && (slot != oldSlot || frameTable.pageNum[frame] != oldPage))
+		logPrintf(LOG_TABLES, "P%d page %d: frame %d\n", slot, frameTable.pageNum[frame], frame);
+}
+
+// Function to print what changed in the process table, frame table and page tables since the last print, and write a
+// full snapshot if one is due
+void snapTick(long long nowNs)
+{
+	bool print = logEnabled(LOG_TABLES);
+	if (print)
+		logPrintf(LOG_TABLES, "\nOSS PID: %d changes from %u:%09u to %u:%09u:\n", getpid(), clockSec(snapLastNs), clockNano(snapLastNs), clockSec(nowNs), clockNano(nowNs));
+
+	// Processes that started or finished
+	for (int i = 0; i < maxProc; i++)
+	{
+		int pid = processTable[i].occupied ? processTable[i].pid : -1;
+		snapRestarted[i] = pid != snapView.pid[i];
+		if (!snapRestarted[i])
+			continue;
+		if (print && snapView.pid[i] != -1)
+			logPrintf(LOG_TABLES, "P%d: PID %d finished\n", i, snapView.pid[i]);
+		if (print && pid != -1)
+			logPrintf(LOG_TABLES, "P%d: PID %d started at %u:%09u\n", i, pid, processTable[i].startSeconds, processTable[i].startNano);
+		snapView.pid[i] = pid;
+	}
+
+	// Frames in ranges marked as changed, each clearing its mark before it is compared so no change is lost
+	int changed = 0, referenced = 0;
+	int groups = ((frameNum + 63) / 64 + 63) / 64;
+	for (int g = 0; g < groups; g++)
+	{
+		unsigned long long ranges = __atomic_exchange_n(&frameChangedRanges[g], 0ULL, __ATOMIC_ACQ_REL);
+		while (ranges != 0)
+		{
+			int word = g * 64 + __builtin_ctzll(ranges);
+			ranges &= ranges - 1;
+			int end = word * 64 + 64 < frameNum ? word * 64 + 64 : frameNum;
+			for (int f = word * 64; f < end; f++)
+			{
+				bool occ = bitTest(frameTable.occupied, f);
+				bool dirty = bitTest(frameTable.dirty, f);
+				int oldSlot = snapView.ownerSlot[f];
+				int oldPage = snapView.pageNum[f];
+				bool moved = frameTable.ownerSlot[f] != oldSlot || frameTable.pageNum[f] != oldPage;
+				if (occ != bitTest(snapView.occupied, f) || dirty != bitTest(snapView.dirty, f) || moved)
+				{
+					changed++;
+					if (print)
+					{
+						logPrintf(LOG_TABLES, "Frame %d: %-8s %-8d %-8lld %-12lld\n", f, occ ? "Yes" : "No", dirty, frameTable.lastRefNs[f] / 1000000000, frameTable.lastRefNs[f] % 1000000000);
+						if (moved)
+							snapPrintMapping(f, oldSlot, oldPage);
+					}
+				}
+				else if (frameTable.lastRefNs[f] != snapView.lastRefNs[f])
+					referenced++;
+				bitAssign(snapView.occupied, f, occ);
+				bitAssign(snapView.dirty, f, dirty);
+				snapView.lastRefNs[f] = frameTable.lastRefNs[f];
+				snapView.ownerSlot[f] = frameTable.ownerSlot[f];
+				snapView.pageNum[f] = frameTable.pageNum[f];
+			}
+		}
+	}
+	if (print)
+		logPrintf(LOG_TABLES, "%d frames changed, %d more only referenced, %d of %d frames free\n\n", changed, referenced, freeTop, frameNum);
+	snapView.header->timeNs = nowNs;
+	snapLastNs = nowNs;
+
+	if (snapCfg.fullEvery > 0 && ++snapTicks >= snapCfg.fullEvery)
+	{
+		snapTicks = 0;
+		snapWrite();
+	}
+}
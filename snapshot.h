@@ -0,0 +1,52 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Printing of only what changed in the tables since the last table print. The pager marks each range of
+// 64 frames whose printed fields change, and every print compares just the marked ranges against a copy of the tables
+// as they were last printed, printing processes that started or finished, frames whose occupancy, dirty bit or page
+// changed, and the page table entries that changed with them. Frames that were only referenced are counted. Every few
+// prints the copy is also written to SNAP_FILE as a full binary snapshot by a background thread, from one of two buffers
+// so the next snapshot can be taken while the last is still being written. Specs given with -U have the form
+// delta[:fullEvery].
+//
+// Each snapshot in SNAP_FILE is a snapHeader_t followed by the occupied and dirty bitsets of (frameNum + 63) / 64 words
+// each, lastRefNs of every frame as long long, owner PCB slot and page of every frame as int (slot -1 if free or shared by
+// every process, page -1 if free), and the pid of every PCB slot as int (-1 if unoccupied). Page tables are not written,
+// since they follow from each frame's owner and page.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#define SNAP_FILE "ossSnapshot.bin" // File full snapshots are written to
+#define SNAP_MAGIC 0x50414e53 // "SNAP", first word of every snapshot
+#define SNAP_VERSION 1 // Version of snapshot layout
+#define DEF_SNAP_EVERY 10 // Default prints between full snapshots
+
+// Structure at start of every snapshot
+typedef struct
+{
+	unsigned magic; // SNAP_MAGIC
+	unsigned version; // SNAP_VERSION
+	long long timeNs; // System time snapshot was taken
+	int frameNum; // Amount of frames
+	int maxProc; // Amount of PCB slots
+	int pageCount; // Amount of pages in each process's page table
+	unsigned pageSize; // Size of a page in bytes
+} snapHeader_t;
+
+// Structure for snapshot settings
+typedef struct
+{
+	bool on; // True if only changes are printed
+	int fullEvery; // Prints between full snapshots, 0 for none
+} snapConfig_t;
+
+extern long long snapWritten; // Full snapshots written
+extern long long snapBytes; // Size of each full snapshot in bytes
+
+bool snapParse(const char* spec, snapConfig_t* cfg);
+void snapInit(const snapConfig_t* cfg);
+bool snapEnabled();
+void snapTick(long long nowNs);
+
+#endif
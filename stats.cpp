@@ -0,0 +1,236 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Latency and fault metrics collected by oss. Each PCB slot remembers when its outstanding request was
+// received and whether it faulted, so the grant can be timed and counted in the matching histograms. Finished
+// processes are kept with their reference and fault counts for the JSON export.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "stats.h"
+#include "arena.h"
+
+hist_t hitSimHist;
+hist_t hitWallHist;
+hist_t faultSimHist;
+hist_t faultWallHist;
+hist_t depthHist;
+hist_t procFaultHist;
+
+// Structure for outstanding request and running counts of a PCB slot
+typedef struct
+{
+	long long reqSimNs; // System time request was received
+	long long reqWallNs; // Real time request was received
+	bool reqFault; // True if request caused a page fault
+	long long refs; // References made by process in slot
+	long long faults; // Page faults of process in slot
+} slotStats_t;
+
+// Structure for a finished process in the JSON export
+typedef struct
+{
+	pid_t pid;
+	long long refs;
+	long long faults;
+} procStats_t;
+
+static arena_t statsArena = { NULL, 0 }; // Arena the stats of each PCB slot are allocated from
+static slotStats_t* slotStats = NULL; // Stats of each PCB slot
+static std::vector<procStats_t> finished; // Every process that has terminated
+static FILE* csvFile = NULL; // Open CSV export, NULL if not exporting
+static bool exporting = false; // True if metrics are written to files
+
+// Function to read real time in ns
+static long long wallNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Function to find bucket holding value. Values below HIST_SUB get a bucket each, larger values are placed by their
+// highest set bit and the HIST_SUB_BITS bits below it.
+static int histIndex(long long value)
+{
+	if (value < HIST_SUB)
+		return value;
+	int top = 63 - __builtin_clzll(value);
+	int sub = (value >> (top - HIST_SUB_BITS)) & (HIST_SUB - 1);
+	return (top - HIST_SUB_BITS + 1) * HIST_SUB + sub;
+}
+
+// Function to find largest value that falls in bucket
+static long long histUpper(int index)
+{
+	if (index < HIST_SUB)
+		return index;
+	int top = index / HIST_SUB + HIST_SUB_BITS - 1;
+	int sub = index % HIST_SUB;
+	long long width = 1LL << (top - HIST_SUB_BITS);
+	return (HIST_SUB + sub) * width + width - 1;
+}
+
+// Function to count value in histogram, negative values are counted as 0
+void histRecord(hist_t* h, long long value)
+{
+	if (value < 0)
+		value = 0;
+	h->counts[histIndex(value)]++;
+	if (h->total == 0 || value < h->min)
+		h->min = value;
+	if (h->total == 0 || value > h->max)
+		h->max = value;
+	h->total++;
+	h->sum += value;
+}
+
+// Function to find value at or below which pct percent of recorded values fall, to within the width of its bucket
+long long histPercentile(const hist_t* h, double pct)
+{
+	if (h->total == 0)
+		return 0;
+	unsigned long long rank = (unsigned long long)(pct / 100.0 * h->total + 0.5);
+	if (rank < 1)
+		rank = 1;
+	unsigned long long seen = 0;
+	for (int i = 0; i < HIST_BUCKETS; i++)
+	{
+		seen += h->counts[i];
+		if (seen >= rank)
+		{
+			long long upper = histUpper(i);
+			return upper < h->max ? upper : h->max;
+		}
+	}
+	return h->max;
+}
+
+// Function to set up stats for slots PCB slots, opening the CSV export and writing its header if exportOn is true
+void statsInit(int slots, bool exportOn)
+{
+	arenaRelease(&statsArena);
+	slotStats = arenaArray<slotStats_t>(&statsArena, slots);
+	exporting = exportOn;
+	if (!exporting)
+		return;
+
+	csvFile = fopen(METRICS_CSV, "w");
+	if (csvFile == NULL)
+	{
+		perror("fopen metrics csv");
+		exit(1);
+	}
+	fprintf(csvFile, "timeNs,refs,faults,waitDepth,running,hitSimP50,hitSimP99,hitSimMax,faultSimP50,faultSimP99,"
+		"faultSimMax,hitWallP50,hitWallP99,hitWallMax,faultWallP50,faultWallP99,faultWallMax\n");
+}
+
+// Function to note request of process in slot as it is received at system time nowNs, with the wait queue depth it sees
+void statsRequest(int slot, long long nowNs, bool fault, int depth)
+{
+	slotStats_t* s = &slotStats[slot];
+	s->reqSimNs = nowNs;
+	s->reqWallNs = wallNs();
+	s->reqFault = fault;
+	s->refs++;
+	if (fault)
+		s->faults++;
+	histRecord(&depthHist, depth);
+}
+
+// Function to count time from request to grant for every slot in slots, granted at system time nowNs
+void statsGrant(const int* slots, int count, long long nowNs)
+{
+	if (count == 0)
+		return;
+	long long now = wallNs();
+	for (int i = 0; i < count; i++)
+	{
+		slotStats_t* s = &slotStats[slots[i]];
+		histRecord(s->reqFault ? &faultSimHist : &hitSimHist, nowNs - s->reqSimNs);
+		histRecord(s->reqFault ? &faultWallHist : &hitWallHist, now - s->reqWallNs);
+	}
+}
+
+// Function to count fault rate of process in slot as it terminates and clear slot for the next process
+void statsExit(int slot, pid_t pid)
+{
+	slotStats_t* s = &slotStats[slot];
+	if (s->refs > 0)
+		histRecord(&procFaultHist, (1000000LL * s->faults) / s->refs);
+	if (exporting)
+		finished.push_back(procStats_t{ pid, s->refs, s->faults });
+	s->refs = 0;
+	s->faults = 0;
+}
+
+// Function to append a row of current percentiles to the CSV export, called every table print
+void statsTick(long long nowNs, long long totRefs, long long totFaults, int depth, int running)
+{
+	if (csvFile == NULL)
+		return;
+	fprintf(csvFile, "%lld,%lld,%lld,%d,%d,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n", nowNs, totRefs,
+		totFaults, depth, running,
+		histPercentile(&hitSimHist, 50), histPercentile(&hitSimHist, 99), hitSimHist.max,
+		histPercentile(&faultSimHist, 50), histPercentile(&faultSimHist, 99), faultSimHist.max,
+		histPercentile(&hitWallHist, 50), histPercentile(&hitWallHist, 99), hitWallHist.max,
+		histPercentile(&faultWallHist, 50), histPercentile(&faultWallHist, 99), faultWallHist.max);
+	fflush(csvFile);
+}
+
+// Function to write one histogram as a JSON object named name, with its non-empty buckets as [upper, count] pairs
+static void histWrite(FILE* out, const char* name, const hist_t* h, bool last)
+{
+	fprintf(out, "    \"%s\": {\"count\": %llu, \"min\": %lld, \"max\": %lld, \"mean\": %.1f, ", name, h->total,
+		h->min, h->max, h->total > 0 ? h->sum / h->total : 0.0);
+	fprintf(out, "\"p50\": %lld, \"p90\": %lld, \"p99\": %lld, \"p999\": %lld, \"buckets\": [", histPercentile(h, 50),
+		histPercentile(h, 90), histPercentile(h, 99), histPercentile(h, 99.9));
+	bool first = true;
+	for (int i = 0; i < HIST_BUCKETS; i++)
+	{
+		if (h->counts[i] == 0)
+			continue;
+		fprintf(out, "%s[%lld, %llu]", first ? "" : ", ", histUpper(i), h->counts[i]);
+		first = false;
+	}
+	fprintf(out, "]}%s\n", last ? "" : ",");
+}
+
+// Function to write final histograms and finished processes to the JSON export, adding a last row to the CSV export
+void statsWrite(const char* policyName, long long nowNs, long long totRefs, long long totFaults)
+{
+	if (!exporting)
+		return;
+	statsTick(nowNs, totRefs, totFaults, 0, 0);
+	if (csvFile != NULL)
+	{
+		fclose(csvFile);
+		csvFile = NULL;
+	}
+
+	FILE* out = fopen(METRICS_JSON, "w");
+	if (out == NULL)
+	{
+		perror("fopen metrics json");
+		exit(1);
+	}
+	fprintf(out, "{\n  \"policy\": \"%s\",\n  \"timeNs\": %lld,\n  \"refs\": %lld,\n  \"faults\": %lld,\n", policyName,
+		nowNs, totRefs, totFaults);
+	fprintf(out, "  \"histograms\": {\n");
+	histWrite(out, "hitSimNs", &hitSimHist, false);
+	histWrite(out, "hitWallNs", &hitWallHist, false);
+	histWrite(out, "faultSimNs", &faultSimHist, false);
+	histWrite(out, "faultWallNs", &faultWallHist, false);
+	histWrite(out, "waitDepth", &depthHist, false);
+	histWrite(out, "procFaultRatePpm", &procFaultHist, true);
+	fprintf(out, "  },\n  \"processes\": [");
+	for (size_t i = 0; i < finished.size(); i++)
+	{
+		fprintf(out, "%s\n    {\"pid\": %d, \"refs\": %lld, \"faults\": %lld}", i == 0 ? "" : ",", finished[i].pid,
+			finished[i].refs, finished[i].faults);
+	}
+	fprintf(out, "\n  ]\n}\n");
+	fclose(out);
+}
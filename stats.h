@@ -0,0 +1,51 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Latency and fault metrics collected by oss. Values are counted in log-linear histograms, where each
+// power of two range is split into HIST_SUB equal buckets, so any value is kept to within about 3% with a fixed amount
+// of memory and recording one is a few instructions. Request-to-grant time of hits and fault-to-completion time of page
+// faults are kept in both system time and real time, along with the wait queue depth seen by each request and the
+// fault rate of each process. With -x, percentiles are appended to a CSV file every table print and the full
+// histograms are written to a JSON file at exit.
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <sys/types.h>
+
+#define METRICS_CSV "ossMetrics.csv" // File a row of percentiles is appended to every table print
+#define METRICS_JSON "ossMetrics.json" // File full histograms are written to at exit
+
+#define HIST_SUB_BITS 5
+#define HIST_SUB (1 << HIST_SUB_BITS) // Buckets in each power of two range
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS) * HIST_SUB) // Enough buckets for any positive long long
+
+// Structure for histogram of non-negative values
+typedef struct
+{
+	unsigned long long counts[HIST_BUCKETS]; // Values recorded in each bucket
+	unsigned long long total; // Amount of values recorded
+	long long min; // Smallest value recorded
+	long long max; // Largest value recorded
+	double sum; // Sum of values recorded, for the mean
+} hist_t;
+
+void histRecord(hist_t* h, long long value);
+long long histPercentile(const hist_t* h, double pct);
+
+// Histograms filled in by the functions below
+extern hist_t hitSimHist; // System time from receiving a hit to granting it, in ns
+extern hist_t hitWallHist; // Real time from receiving a hit to granting it, in ns
+extern hist_t faultSimHist; // System time from a page fault to granting its request, in ns
+extern hist_t faultWallHist; // Real time from a page fault to granting its request, in ns
+extern hist_t depthHist; // Wait queue depth seen by each request
+extern hist_t procFaultHist; // Fault rate of each finished process, in parts per million
+
+void statsInit(int slots, bool exportOn);
+void statsRequest(int slot, long long nowNs, bool fault, int depth);
+void statsGrant(const int* slots, int count, long long nowNs);
+void statsExit(int slot, pid_t pid);
+void statsTick(long long nowNs, long long totRefs, long long totFaults, int depth, int running);
+void statsWrite(const char* policyName, long long nowNs, long long totRefs, long long totFaults);
+
+#endif
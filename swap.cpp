@@ -0,0 +1,134 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Swap device model. The device keeps the time it finishes its last queued request, so a new request
+// starts once both it arrives and the device is free. The cleaner asks the replacement policy for the frames it would
+// evict next and writes back the dirty ones.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "swap.h"
+#include "pager.h"
+
+long long swapReads = 0;
+long long swapWrites = 0;
+long long swapPrefetches = 0;
+long long swapCleaned = 0;
+long long swapBusyNs = 0;
+long long swapReadNs = 0;
+
+static swapConfig_t swapCfg = { false, 0, 0, 0 }; // Settings in use
+static long long swapXferNs = 0; // Time to move one page at device bandwidth
+static long long swapFreeNs = 0; // Time device finishes every request queued so far
+static arena_t swapArena = { NULL, 0 }; // Arena the cleaner's frame list is allocated from
+static int* coldFrames = NULL; // Frames closest to eviction, filled by policy for the cleaner
+
+// Function to parse a non-negative number from start of str into value, returns pointer past it or NULL if none
+static const char* parseNum(const char* str, long long* value)
+{
+	char* end;
+	if (*str < '0' || *str > '9')
+		return NULL;
+	*value = strtoll(str, &end, 10);
+	return end;
+}
+
+// Function to parse swap device spec into cfg, returns false if spec is not valid
+bool swapParse(const char* spec, swapConfig_t* cfg)
+{
+	long long latencyUs, bandwidthMB, clean = 0;
+	const char* p = parseNum(spec, &latencyUs);
+	if (p == NULL || *p != ':')
+		return false;
+	p = parseNum(p + 1, &bandwidthMB);
+	if (p == NULL || bandwidthMB < 1)
+		return false;
+	if (*p == ':')
+	{
+		p = parseNum(p + 1, &clean);
+		if (p == NULL || clean > 1000000)
+			return false;
+	}
+	if (*p != '\0')
+		return false;
+
+	cfg->on = true;
+	cfg->latencyNs = latencyUs * 1000;
+	cfg->bandwidth = bandwidthMB * 1000000;
+	cfg->cleanFrames = (int)clean;
+	return true;
+}
+
+// Function to set up device with settings in cfg for pages of pageSize bytes, idle and with nothing transferred
+void swapInit(const swapConfig_t* cfg, unsigned pageSize)
+{
+	swapCfg = *cfg;
+	arenaRelease(&swapArena);
+	coldFrames = NULL;
+	if (!swapCfg.on)
+		return;
+	swapXferNs = (long long)pageSize * 1000000000LL / swapCfg.bandwidth;
+	swapFreeNs = 0;
+	if (swapCfg.cleanFrames > 0)
+		coldFrames = arenaArray<int>(&swapArena, swapCfg.cleanFrames);
+}
+
+// Function to check if faults are serviced by the device model
+bool swapEnabled()
+{
+	return swapCfg.on;
+}
+
+// Function to queue one page transfer on the device at nowNs, returns time it completes
+static long long swapSubmit(long long nowNs)
+{
+	long long startNs = nowNs > swapFreeNs ? nowNs : swapFreeNs;
+	swapFreeNs = startNs + swapCfg.latencyNs + swapXferNs;
+	swapBusyNs += swapCfg.latencyNs + swapXferNs;
+	return swapFreeNs;
+}
+
+// Function to queue read of a faulted page at nowNs, returns time the page is in memory
+long long swapRead(long long nowNs)
+{
+	long long doneNs = swapSubmit(nowNs);
+	swapReads++;
+	swapReadNs += doneNs - nowNs;
+	return doneNs;
+}
+
+// Function to queue writeback of a dirty victim at nowNs. Its frame is reused right away, the page being copied out
+// while the incoming page is read, so no process waits for it.
+void swapWrite(long long nowNs)
+{
+	swapSubmit(nowNs);
+	swapWrites++;
+}
+
+// Function to queue read of a prefetched page at nowNs, which no process waits for
+void swapPrefetch(long long nowNs)
+{
+	swapSubmit(nowNs);
+	swapPrefetches++;
+}
+
+// Function to write back dirty frames that are about to be evicted, if the device has nothing queued at nowNs. Frames
+// are marked clean as soon as their writeback is queued, and a later write to them makes them dirty again.
+void swapClean(long long nowNs)
+{
+	if (coldFrames == NULL || policy->cold == NULL || swapFreeNs > nowNs)
+		return;
+
+	int count = policy->cold(coldFrames, swapCfg.cleanFrames);
+	for (int i = 0; i < count; i++)
+	{
+		int frame = coldFrames[i];
+		if (!bitTest(frameTable.dirty, frame))
+			continue;
+		frameChanged(frame);
+		bitAssign(frameTable.dirty, frame, false);
+		swapSubmit(nowNs);
+		swapCleaned++;
+	}
+}
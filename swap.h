@@ -0,0 +1,40 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Model of the swap device page faults are serviced from. The device serves one page at a time in the
+// order requests arrive, each taking its latency plus the time to move a page at its bandwidth, so faults that arrive
+// together queue behind each other. Dirty victims are written back asynchronously, so the faulting process only waits
+// for its own read, and an optional cleaner writes back dirty frames the policy will evict soon whenever the device is
+// idle, so evictions find clean frames. Specs given with -D have the form latencyUs:bandwidthMBps[:cleanFrames].
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#define FAULT_READ_NS 14000000 // Fixed time to service a fault without a swap device
+#define FAULT_WRITE_NS 1000000 // Extra fixed time for a write fault without a swap device
+
+// Structure for swap device settings
+typedef struct
+{
+	bool on; // True if faults are serviced by the device model
+	long long latencyNs; // Time before each transfer starts
+	long long bandwidth; // Bytes moved per second
+	int cleanFrames; // Frames closest to eviction the cleaner checks, 0 for no cleaner
+} swapConfig_t;
+
+extern long long swapReads; // Pages read for faults
+extern long long swapWrites; // Dirty victims written back when evicted
+extern long long swapPrefetches; // Pages read for prefetching
+extern long long swapCleaned; // Dirty frames written back ahead of eviction by the cleaner
+extern long long swapBusyNs; // Total time device spent serving requests
+extern long long swapReadNs; // Total time from submitting a read to its completion, including queueing
+
+bool swapParse(const char* spec, swapConfig_t* cfg);
+void swapInit(const swapConfig_t* cfg, unsigned pageSize);
+bool swapEnabled();
+long long swapRead(long long nowNs);
+void swapWrite(long long nowNs);
+void swapPrefetch(long long nowNs);
+void swapClean(long long nowNs);
+
+#endif
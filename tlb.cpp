@@ -0,0 +1,210 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Simulated translation lookaside buffer. A page maps to the set given by its low bits, and each set keeps
+// the time of last use of its entries so the least recently used one is replaced. In per-process mode every PCB slot
+// has its own block of sets, otherwise every slot shares one block.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tlb.h"
+#include "arena.h"
+
+long long tlbHits = 0;
+long long tlbMisses = 0;
+long long tlbFlushes = 0;
+
+// Structure for a TLB entry
+typedef struct
+{
+	unsigned page; // Page translated
+	int asid; // PCB slot of process page belongs to
+	int frame; // Frame holding page, -1 if entry is empty
+	unsigned long long lastUse; // Lookup count when entry was last used
+} tlbEntry_t;
+
+static tlbConfig_t tlbCfg = { TLB_OFF, 0, 0 }; // Settings in use
+static arena_t tlbArena = { NULL, 0 }; // Arena the entries are allocated from
+static tlbEntry_t* tlbEntries = NULL; // Every entry of every TLB
+static int tlbSets = 0; // Sets in each TLB
+static int tlbBlocks = 0; // Amount of TLBs, one per slot in per-process mode
+static int tlbLastSlot = -1; // Slot of last lookup, to detect context switches
+static unsigned long long tlbTick = 0; // Lookups so far, used as time of last use
+
+// Function to check if value is a power of two
+static bool isPow2(long value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+// Function to parse TLB spec into cfg, returns false if spec is not valid
+bool tlbParse(const char* spec, tlbConfig_t* cfg)
+{
+	cfg->entries = DEF_TLB_ENTRIES;
+	cfg->ways = DEF_TLB_WAYS;
+
+	// Split mode from parameters
+	const char* colon = strchr(spec, ':');
+	size_t nameLen = colon ? (size_t)(colon - spec) : strlen(spec);
+	if (nameLen == 3 && strncmp(spec, "off", nameLen) == 0)
+	{
+		cfg->mode = TLB_OFF;
+		return colon == NULL;
+	}
+	if (nameLen == 6 && strncmp(spec, "global", nameLen) == 0)
+		cfg->mode = TLB_GLOBAL;
+	else if (nameLen == 5 && strncmp(spec, "flush", nameLen) == 0)
+		cfg->mode = TLB_FLUSH;
+	else if (nameLen == 4 && strncmp(spec, "proc", nameLen) == 0)
+		cfg->mode = TLB_PROC;
+	else
+		return false;
+	if (colon == NULL)
+		return true;
+
+	char* end;
+	long entries = strtol(colon + 1, &end, 10);
+	cfg->entries = entries;
+	if (!isPow2(entries) || (*end != '\0' && *end != ':'))
+		return false;
+	if (*end == ':')
+	{
+		long ways = strtol(end + 1, &end, 10);
+		cfg->ways = ways;
+		if (*end != '\0' || !isPow2(ways))
+			return false;
+	}
+	else if (cfg->ways > entries)
+		cfg->ways = entries;
+	return cfg->ways <= entries;
+}
+
+// Function to set up TLB with settings in cfg for slots PCB slots, with every entry empty
+void tlbInit(const tlbConfig_t* cfg, int slots)
+{
+	tlbCfg = *cfg;
+	arenaRelease(&tlbArena);
+	tlbEntries = NULL;
+	if (tlbCfg.mode == TLB_OFF)
+		return;
+	tlbSets = tlbCfg.entries / tlbCfg.ways;
+	tlbBlocks = tlbCfg.mode == TLB_PROC ? slots : 1;
+	tlbEntries = arenaArray<tlbEntry_t>(&tlbArena, (size_t)tlbBlocks * tlbCfg.entries);
+	for (long i = 0; i < (long)tlbBlocks * tlbCfg.entries; i++)
+	{
+		tlbEntries[i].frame = -1;
+	}
+}
+
+// Function to check if a TLB is in use
+bool tlbEnabled()
+{
+	return tlbCfg.mode != TLB_OFF;
+}
+
+// Function to find first entry of set page maps to in TLB used by slot
+static tlbEntry_t* tlbSet(int slot, unsigned page)
+{
+	long block = tlbCfg.mode == TLB_PROC ? slot : 0;
+	return tlbEntries + block * tlbCfg.entries + (long)(page & (tlbSets - 1)) * tlbCfg.ways;
+}
+
+// Function to check if entry translates page of process in slot
+static bool tlbMatch(const tlbEntry_t* e, int slot, unsigned page)
+{
+	return e->frame != -1 && e->page == page && (tlbCfg.mode != TLB_GLOBAL || e->asid == slot);
+}
+
+// Function to switch TLB to process in slot, flushing every entry in flush mode if it is a different process than the
+// current one
+static void tlbSwitch(int slot)
+{
+	if (tlbCfg.mode == TLB_FLUSH && slot != tlbLastSlot)
+	{
+		for (int i = 0; i < tlbCfg.entries; i++)
+		{
+			tlbEntries[i].frame = -1;
+		}
+		tlbFlushes++;
+	}
+	tlbLastSlot = slot;
+}
+
+// Function to find frame of page of process in slot in the TLB, returns -1 on a miss
+int tlbLookup(int slot, unsigned page)
+{
+	tlbSwitch(slot);
+	tlbTick++;
+
+	tlbEntry_t* set = tlbSet(slot, page);
+	for (int w = 0; w < tlbCfg.ways; w++)
+	{
+		if (tlbMatch(&set[w], slot, page))
+		{
+			set[w].lastUse = tlbTick;
+			tlbHits++;
+			return set[w].frame;
+		}
+	}
+	tlbMisses++;
+	return -1;
+}
+
+// Function to add translation of page of process in slot to frame, replacing an empty or least recently used entry.
+// The process is about to run again, so in flush mode this is a context switch to it.
+void tlbInsert(int slot, unsigned page, int frame)
+{
+	if (tlbCfg.mode == TLB_OFF)
+		return;
+	tlbSwitch(slot);
+	tlbEntry_t* set = tlbSet(slot, page);
+	tlbEntry_t* victim = &set[0];
+	for (int w = 0; w < tlbCfg.ways; w++)
+	{
+		// Update entry already holding page, or stop at first empty entry
+		if (tlbMatch(&set[w], slot, page) || set[w].frame == -1)
+		{
+			victim = &set[w];
+			break;
+		}
+		if (set[w].lastUse < victim->lastUse)
+			victim = &set[w];
+	}
+	victim->page = page;
+	victim->asid = slot;
+	victim->frame = frame;
+	victim->lastUse = ++tlbTick;
+}
+
+// Function to remove translation of page of process in slot, called when its frame is evicted
+void tlbInvalidate(int slot, unsigned page)
+{
+	if (tlbCfg.mode == TLB_OFF)
+		return;
+	// In flush mode entries have no tag, so only remove the page if it is the current process's
+	if (tlbCfg.mode == TLB_FLUSH && slot != tlbLastSlot)
+		return;
+	tlbEntry_t* set = tlbSet(slot, page);
+	for (int w = 0; w < tlbCfg.ways; w++)
+	{
+		if (tlbMatch(&set[w], slot, page))
+			set[w].frame = -1;
+	}
+}
+
+// Function to remove every translation of process in slot, called when it terminates
+void tlbFlushSlot(int slot)
+{
+	if (tlbCfg.mode == TLB_OFF || (tlbCfg.mode == TLB_FLUSH && slot != tlbLastSlot))
+		return;
+	tlbEntry_t* block = tlbEntries;
+	int count = tlbCfg.entries;
+	if (tlbCfg.mode == TLB_PROC)
+		block += (long)slot * tlbCfg.entries;
+	for (int i = 0; i < count; i++)
+	{
+		if (tlbCfg.mode != TLB_GLOBAL || block[i].asid == slot)
+			block[i].frame = -1;
+	}
+}
@@ -0,0 +1,44 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Simulated translation lookaside buffer in front of the page tables. The TLB is set associative, with
+// least recently used replacement within each set, and is either shared by every process with entries tagged by
+// address space, shared and flushed whenever a request comes from a different process than the last, or private to each
+// PCB slot. Entries are removed when the pager evicts their page and when their process terminates. Specs given with
+// -T have the form mode[:entries[:ways]], for example global:64:4.
+
+#ifndef TLB_H
+#define TLB_H
+
+// TLB modes
+#define TLB_OFF 0 // No TLB, every reference reads the page table
+#define TLB_GLOBAL 1 // One TLB shared by every process, entries tagged with PCB slot as address space ID
+#define TLB_FLUSH 2 // One TLB shared by every process without tags, flushed on every context switch
+#define TLB_PROC 3 // One TLB for each PCB slot
+
+#define DEF_TLB_ENTRIES 64 // Default entries in each TLB
+#define DEF_TLB_WAYS 4 // Default entries in each set
+#define TLB_HIT_NS 1 // Time charged for a translation found in the TLB
+#define TLB_WALK_NS 100 // Time charged for reading the page table after a TLB miss
+
+// Structure for TLB settings
+typedef struct
+{
+	int mode; // One of the TLB_ values
+	int entries; // Entries in each TLB, a power of two
+	int ways; // Entries in each set, a power of two no larger than entries
+} tlbConfig_t;
+
+extern long long tlbHits; // Translations found in the TLB
+extern long long tlbMisses; // Translations that read the page table
+extern long long tlbFlushes; // Times the whole TLB was flushed on a context switch
+
+bool tlbParse(const char* spec, tlbConfig_t* cfg);
+void tlbInit(const tlbConfig_t* cfg, int slots);
+bool tlbEnabled();
+int tlbLookup(int slot, unsigned page);
+void tlbInsert(int slot, unsigned page, int frame);
+void tlbInvalidate(int slot, unsigned page);
+void tlbFlushSlot(int slot);
+
+#endif
@@ -0,0 +1,148 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Binary trace recording and replay. While recording, the file is extended TRACE_GROW records at a time
+// and remapped, so appending a record is a copy into mapped memory. On close the file is cut to the records written and
+// the count is stored in the header.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+static int traceFd = -1; // File descriptor of trace being recorded or replayed
+static void* traceMap = NULL; // Mapping of whole trace file
+static size_t traceMapSize = 0; // Size of mapping in bytes
+static unsigned long long traceCount = 0; // Records written so far while recording
+static unsigned long long traceCap = 0; // Records mapping has room for while recording
+
+// Function to map trace file with room for cap records, replacing the current mapping
+static void traceRemap(unsigned long long cap)
+{
+	if (traceMap != NULL && munmap(traceMap, traceMapSize) == -1)
+	{
+		perror("munmap trace");
+		exit(1);
+	}
+	traceMapSize = sizeof(traceHeader_t) + cap * sizeof(traceRec_t);
+	if (ftruncate(traceFd, traceMapSize) == -1)
+	{
+		perror("ftruncate trace");
+		exit(1);
+	}
+	traceMap = mmap(NULL, traceMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, traceFd, 0);
+	if (traceMap == MAP_FAILED)
+	{
+		perror("mmap trace");
+		exit(1);
+	}
+	traceCap = cap;
+}
+
+// Function to create trace file at path and write its header for a run with the given page size and page count
+void traceCreate(const char* path, unsigned pageSize, unsigned pageCount)
+{
+	traceFd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (traceFd == -1)
+	{
+		perror("open trace");
+		exit(1);
+	}
+	traceCount = 0;
+	traceRemap(TRACE_GROW);
+
+	traceHeader_t* header = (traceHeader_t*)traceMap;
+	memcpy(header->magic, TRACE_MAGIC, sizeof(header->magic));
+	header->version = TRACE_VERSION;
+	header->recSize = sizeof(traceRec_t);
+	header->pageSize = pageSize;
+	header->pageCount = pageCount;
+	header->count = 0;
+}
+
+// Function to add record to end of trace, growing the file if the mapping is full
+void traceAppend(const traceRec_t* rec)
+{
+	if (traceCount == traceCap)
+		traceRemap(traceCap + TRACE_GROW);
+	traceRec_t* recs = (traceRec_t*)((traceHeader_t*)traceMap + 1);
+	recs[traceCount++] = *rec;
+}
+
+// Function to store record count, cut file to records written and close it
+void traceClose()
+{
+	if (traceFd == -1)
+		return;
+	((traceHeader_t*)traceMap)->count = traceCount;
+	if (munmap(traceMap, traceMapSize) == -1)
+	{
+		perror("munmap trace");
+		exit(1);
+	}
+	if (ftruncate(traceFd, sizeof(traceHeader_t) + traceCount * sizeof(traceRec_t)) == -1)
+	{
+		perror("ftruncate trace");
+		exit(1);
+	}
+	close(traceFd);
+	traceFd = -1;
+	traceMap = NULL;
+}
+
+// Function to map trace file at path read-only and check its header, returns first record
+const traceRec_t* traceOpen(const char* path, traceHeader_t* header)
+{
+	traceFd = open(path, O_RDONLY);
+	if (traceFd == -1)
+	{
+		fprintf(stderr, "Error! Failed to open %s for replay.\n", path);
+		exit(1);
+	}
+	struct stat st;
+	if (fstat(traceFd, &st) == -1)
+	{
+		perror("fstat trace");
+		exit(1);
+	}
+	if ((size_t)st.st_size < sizeof(traceHeader_t))
+	{
+		fprintf(stderr, "Error! %s is not a trace file.\n", path);
+		exit(1);
+	}
+	traceMapSize = st.st_size;
+	traceMap = mmap(NULL, traceMapSize, PROT_READ, MAP_PRIVATE, traceFd, 0);
+	if (traceMap == MAP_FAILED)
+	{
+		perror("mmap trace");
+		exit(1);
+	}
+	// Records are read in order, let the kernel read ahead
+	madvise(traceMap, traceMapSize, MADV_SEQUENTIAL);
+
+	// Ensure file is a complete trace written by this version
+	*header = *(traceHeader_t*)traceMap;
+	if (memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 || header->version != TRACE_VERSION ||
+		header->recSize != sizeof(traceRec_t) ||
+		traceMapSize != sizeof(traceHeader_t) + header->count * sizeof(traceRec_t))
+	{
+		fprintf(stderr, "Error! %s is not a complete trace file.\n", path);
+		exit(1);
+	}
+	return (const traceRec_t*)((traceHeader_t*)traceMap + 1);
+}
+
+// Function to unmap and close trace being replayed
+void traceUnmap()
+{
+	if (traceFd == -1)
+		return;
+	munmap(traceMap, traceMapSize);
+	close(traceFd);
+	traceFd = -1;
+	traceMap = NULL;
+}
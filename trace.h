@@ -0,0 +1,62 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Binary trace of memory references used by oss to record a run and replay it later. The trace file is a
+// header followed by fixed-width records, written sequentially through a memory mapping that grows as records are added
+// and read back through a read-only mapping.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define TRACE_FILE "refTrace.bin" // File trace is recorded to and replayed from
+#define TRACE_MAGIC "OSSTRACE" // First 8 bytes of every trace file
+#define TRACE_VERSION 1
+#define TRACE_GROW 65536 // Records mapping grows by each time it fills
+
+// Record types
+#define TR_REF 0 // Memory reference serviced by the pager
+#define TR_EXIT 1 // Process terminated and released its frames
+
+// Structure at start of trace file
+typedef struct
+{
+	char magic[8]; // TRACE_MAGIC, not null terminated
+	unsigned version; // TRACE_VERSION
+	unsigned recSize; // Size of each record, sizeof(traceRec_t)
+	unsigned pageSize; // Page size of recorded run
+	unsigned pageCount; // Pages in each address space of recorded run
+	unsigned long long count; // Amount of records that follow
+} traceHeader_t;
+
+// Structure for one record. References are recorded in the order the pager serviced them, so a fault is recorded when
+// its page is loaded, with the time it was requested.
+typedef struct
+{
+	long long timeNs; // System time of request, or of termination
+	pid_t pid; // PID of process
+	int slot; // PCB slot of process
+	unsigned address; // Address referenced
+	int frame; // Frame holding page once serviced
+	pid_t victimPid; // PID of process whose page was evicted to make room, -1 if no page was evicted
+	int victimPage; // Page that was evicted, -1 if no page was evicted
+	unsigned char type; // TR_REF or TR_EXIT
+	unsigned char isWrite; // True if reference was a write
+	unsigned char fault; // True if reference caused a page fault
+	unsigned char pad[5]; // Keeps records 8 byte aligned
+} traceRec_t;
+
+static_assert(sizeof(traceRec_t) == 40, "trace records must stay fixed width");
+
+// Recording, defined in trace.cpp
+void traceCreate(const char* path, unsigned pageSize, unsigned pageCount);
+void traceAppend(const traceRec_t* rec);
+void traceClose();
+
+// Replay, returns first record of mapped trace and fills in header
+const traceRec_t* traceOpen(const char* path, traceHeader_t* header);
+void traceUnmap();
+
+#endif
@@ -0,0 +1,195 @@
+// Operating Systems Project 6
+// Author: Maija Garson
+// Date: 05/15/2025
+// Description: Message format and shared memory ring transport used between oss and worker. With the ring transport,
+// oss creates one slot per PCB entry in a shared memory segment. Each slot holds a single producer single consumer ring
+// that the worker in that PCB slot posts requests to, and a completion word oss increments once the request is granted.
+// Workers spin briefly on the completion word, unless they have a single processor, and then sleep on it with a futex,
+// so no system call is needed while requests are answered quickly. The segment starts with a header holding a doorbell
+// word oss can sleep on while waiting for requests in discrete event mode.
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <atomic>
+#include <limits.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define RING_SIZE 16 // Requests each slot's ring can hold, must be a power of two
+#define RING_SPIN 2000 // Times oss or a worker checks for the other's message before sleeping, on more than one processor
+
+// Message buffer for communication between OSS and child processes
+typedef struct msgbuffer
+{
+	long mtype; // Message type used for message queue
+	pid_t pid;
+	unsigned address;
+	bool isWrite;
+	bool granted; // Grant resources to worker
+	bool terminating; // Discrete event mode, worker is exiting and will send no more requests
+	long long actNs; // Discrete event mode, time worker makes request, or time request was granted in replies
+} msgbuffer;
+
+// Structure for a single producer single consumer ring of requests
+typedef struct
+{
+	alignas(64) std::atomic<unsigned> head; // Next entry to be read, only written by oss
+	alignas(64) std::atomic<unsigned> tail; // Next entry to be written, only written by worker
+	msgbuffer msgs[RING_SIZE]; // Posted requests
+} spscRing_t;
+
+// Structure for one PCB slot in the ring segment
+typedef struct
+{
+	spscRing_t request; // Requests from worker to oss
+	alignas(64) std::atomic<unsigned> done; // Completion word, incremented by oss for every grant
+	std::atomic<int> sleeping; // True while worker is sleeping on completion word
+	msgbuffer reply; // Last reply from oss, valid once done has been incremented
+} ringSlot_t;
+
+// Structure at start of ring segment, followed by one ringSlot_t per PCB slot
+typedef struct
+{
+	alignas(64) std::atomic<unsigned> doorbell; // Incremented by workers posting while oss sleeps
+	std::atomic<int> sleeping; // True while oss is sleeping on doorbell
+} ringHeader_t;
+
+// Function to find slot array that follows header in ring segment
+static inline ringSlot_t* ringSlots(ringHeader_t* header)
+{
+	return (ringSlot_t*)(header + 1);
+}
+
+// Function to find times to check for a message before sleeping on it. With a single processor the other side cannot
+// run while the caller spins, so it sleeps at once.
+static inline int ringSpinLimit()
+{
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) == 1)
+		return 0;
+	return RING_SPIN;
+}
+
+// Function to wait on or wake a futex shared between processes
+static inline long futex(std::atomic<unsigned>* addr, int op, unsigned val)
+{
+	return syscall(SYS_futex, (unsigned*)addr, op, val, NULL, NULL, 0);
+}
+
+// Function to post request to ring, returns false if ring is full
+static inline bool ringPush(spscRing_t* ring, const msgbuffer* msg)
+{
+	unsigned tail = ring->tail.load(std::memory_order_relaxed);
+	if (tail - ring->head.load(std::memory_order_acquire) == RING_SIZE)
+		return false;
+	ring->msgs[tail & (RING_SIZE - 1)] = *msg;
+	ring->tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+// Function to take oldest request from ring, returns false if ring is empty
+static inline bool ringPop(spscRing_t* ring, msgbuffer* msg)
+{
+	unsigned head = ring->head.load(std::memory_order_relaxed);
+	if (head == ring->tail.load(std::memory_order_acquire))
+		return false;
+	*msg = ring->msgs[head & (RING_SIZE - 1)];
+	ring->head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+// Function for worker to wake oss after posting, if oss went to sleep waiting for requests
+static inline void ringNotify(ringHeader_t* header)
+{
+	// Order post before check of sleeping flag, pairing with fence in ringSleep
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (header->sleeping.load())
+	{
+		header->doorbell.fetch_add(1);
+		futex(&header->doorbell, FUTEX_WAKE, 1);
+	}
+}
+
+// Function for oss to announce it is about to sleep, returns doorbell value to pass to ringSleep. Rings must be
+// checked once more after this so a request posted before the announcement is not missed.
+static inline unsigned ringPrepareSleep(ringHeader_t* header)
+{
+	unsigned seen = header->doorbell.load();
+	header->sleeping.store(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	return seen;
+}
+
+// Function for oss to take back its announcement after finding a request
+static inline void ringCancelSleep(ringHeader_t* header)
+{
+	header->sleeping.store(0);
+}
+
+// Function for oss to sleep until a worker rings the doorbell
+static inline void ringSleep(ringHeader_t* header, unsigned seen)
+{
+	futex(&header->doorbell, FUTEX_WAIT, seen);
+	header->sleeping.store(0);
+}
+
+// Function to reset slot before a new worker is given it
+static inline void ringReset(ringSlot_t* slot)
+{
+	slot->request.head.store(0);
+	slot->request.tail.store(0);
+	slot->done.store(0);
+	slot->sleeping.store(0);
+}
+
+// Function for oss to publish reply, making it visible to the worker waiting on the slot
+static inline void ringPublish(ringSlot_t* slot, const msgbuffer* msg)
+{
+	slot->reply = *msg;
+	slot->done.fetch_add(1);
+}
+
+// Function for oss to wake worker if it went to sleep on its completion word
+static inline void ringWake(ringSlot_t* slot)
+{
+	if (slot->sleeping.load())
+		futex(&slot->done, FUTEX_WAKE, INT_MAX);
+}
+
+// Function for oss to publish reply and wake worker if it is sleeping on its completion word
+static inline void ringComplete(ringSlot_t* slot, const msgbuffer* msg)
+{
+	ringPublish(slot, msg);
+	ringWake(slot);
+}
+
+// Function for worker to wait until completion word moves past seen, checking it up to spin times before sleeping,
+// then copy reply
+static inline void ringWait(ringSlot_t* slot, unsigned seen, msgbuffer* msg, int spin)
+{
+	// Spin for a short time, since oss usually answers quickly
+	for (int i = 0; i < spin; i++)
+	{
+		if (slot->done.load(std::memory_order_acquire) != seen)
+		{
+			*msg = slot->reply;
+			return;
+		}
+	}
+
+	// Sleep on completion word, rechecking after announcing so a wake cannot be missed
+	while (slot->done.load() == seen)
+	{
+		slot->sleeping.store(1);
+		if (slot->done.load() == seen)
+			futex(&slot->done, FUTEX_WAIT, seen);
+		slot->sleeping.store(0);
+	}
+	*msg = slot->reply;
+}
+
+#endif
@@ -7,6 +7,13 @@
 // update its values if the message was granted. Each time it sends/receives a message it will increment the system clock. It will also continuously check every
 // 250000000 ns if it has run for 1 sec. If it has run for that time, it will randomly generate a probability to determine if it should terminate or continue looping.
 // Once it terminates, it will release all held resources, detaches from shared memory, and exit.
+// oss passes the transport to use with -t and the worker's PCB slot with -k. With the ring transport, requests are posted
+// to the slot's ring in shared memory and the worker waits on the slot's completion word instead of the message queue.
+// With -d, the worker runs in discrete event mode and sleeps between requests instead of polling the clock. The pages
+// and page size of its address space are passed with -g and -z, and the reference generator and percent of writes
+// with -w and -W.
+// Timing, termination and request generation come from the reference stream in refgen.cpp, which oss also uses to run
+// workers in-process.
 
 #include <string.h>
 #include <stdio.h>
@@ -18,34 +25,34 @@
 #include <sys/msg.h>
 #include <cstdio>
 #include <cstdlib>
+#include "transport.h"
+#include "refgen.h"
+#include "simclock.h"
 
 #define PERMS 0644
-#define BOUND_NS 1000
-#define TERM_CHECK_NS 250000000
-#define LIFE_NS 2000000000
-#define TERM_PROB 40
 
-// Message buffer structure
-typedef struct msgbuffer
-{
-	long mtype; 
-	pid_t pid;
-	unsigned address;
-	bool isWrite;	
-	bool granted;
-} msgbuffer;
-
-// Shared memory pointers for system clock
-int *shm_ptr;
+// Shared memory system clock
+simClock_t* simClock;
 int shm_id;
 
+// Shared memory pointers for ring slots when using ring transport
+ringHeader_t* ringHeader = NULL;
+ringSlot_t* ringSeg = NULL;
+int ring_id;
+
+// Transport options given by oss
+bool useRing = false; // True if requests go through ring in shared memory
+int slot = -1; // PCB slot whose ring this worker posts to
+int ringSpin = RING_SPIN; // Times to check for a reply before sleeping on it
+int msqid = 0; // Queue ID for communication
+
 // Function to attach to shared memory
 void shareMem()
 {
 	// Generate key
 	const int sh_key = ftok("main.c", 0);
 	// Access shared memory
-	shm_id = shmget(sh_key, sizeof(int) * 2, 0666);
+	shm_id = shmget(sh_key, sizeof(simClock_t), 0666);
 
 	// Determine if shared memory access not successful
 	if (shm_id == -1)
@@ -56,9 +63,9 @@ void shareMem()
 	}
 
 	// Attach shared memory
-	shm_ptr = (int *)shmat(shm_id, 0, 0);
+	simClock = (simClock_t *)shmat(shm_id, 0, 0);
 	//Determine if insuccessful
-	if (shm_ptr == (int *)-1)
+	if (simClock == (simClock_t *)-1)
 	{
 		// If true, print error message and exit
 		fprintf(stderr, "Child: Shared memory attach failed.\n");
@@ -66,28 +73,165 @@ void shareMem()
 	}
 }
 
-// Function to increment time by 1000 ns 
-void addTime()
+// Function to attach to ring segment created by oss
+void shareRing()
+{
+	// Generate key from same file as message queue
+	key_t ring_key = ftok("msgq.txt", 2);
+	// Access existing shared memory
+	ring_id = shmget(ring_key, 0, 0666);
+	if (ring_id == -1)
+	{
+		fprintf(stderr, "Child: Ring shared memory get failed.\n");
+		exit(1);
+	}
+
+	// Attach shared memory
+	ringHeader = (ringHeader_t *)shmat(ring_id, 0, 0);
+	if (ringHeader == (ringHeader_t *)-1)
+	{
+		fprintf(stderr, "Child: Ring shared memory attach failed.\n");
+		exit(1);
+	}
+	ringSeg = ringSlots(ringHeader);
+}
+
+// Function to send request to oss through the transport in use, returns completion count to pass to waitReply
+unsigned sendRequest(msgbuffer* msg)
 {
-	shm_ptr[1] += 1000;
-	// Ensure ns did not overflow 
-	if (shm_ptr[1] > 1000000000) 
+	if (useRing)
+	{
+		// Post request to slot's ring and remember completion count to wait past
+		ringSlot_t* mine = &ringSeg[slot];
+		unsigned seen = mine->done.load();
+		while (!ringPush(&mine->request, msg))
+			;
+		// Wake oss in case it is sleeping while waiting for requests
+		ringNotify(ringHeader);
+		return seen;
+	}
+
+	// Send message to oss
+	if (msgsnd(msqid, msg, sizeof(msgbuffer) - sizeof(long), 0) == -1)
+	{
+		perror("child msgsnd");
+		exit(1);
+	}
+	return 0;
+}
+
+// Function to wait for reply from oss through the transport in use
+void waitReply(unsigned seen, msgbuffer* reply)
+{
+	if (useRing)
+	{
+		// Wait for oss to complete request
+		ringWait(&ringSeg[slot], seen, reply, ringSpin);
+		return;
+	}
+
+	// Wait to receive message back from oss
+	if (msgrcv(msqid, reply, sizeof(msgbuffer) - sizeof(long), getpid(), 0) == -1)
+	{
+		perror("child msgrcv");
+		exit(1);
+	}
+}
+
+// Function to detach from shared memory and exit
+void detachAndExit()
+{
+	if (shmdt(simClock) == -1)
+	{
+		perror("shmdt failed");
+		exit(1);
+	}
+	if (useRing && shmdt(ringHeader) == -1)
 	{
-		shm_ptr[1] -= 1000000000;
-		shm_ptr[0]++;
+		perror("shmdt ring failed");
+		exit(1);
 	}
+	exit(0);
+}
+
+// Function to increment time by 1000 ns, a single atomic add so it can never be lost to a concurrent update by oss
+void addTime()
+{
+	clockAdd(1000);
 }
 
 int main(int argc, char* argv[])
 {
+	// Parse transport, PCB slot and simulation mode given by oss
+	bool des = false;
+	unsigned pageCount = 32; // Defaults match oss
+	unsigned pageSize = 1024;
+	unsigned writePct = DEF_WRITE_PCT;
+	const char* gen = DEF_GEN;
+	int opt;
+	while ((opt = getopt(argc, argv, "t:k:dg:z:w:W:")) != -1)
+	{
+		switch (opt)
+		{
+			case 't':
+				useRing = strcmp(optarg, "ring") == 0;
+				break;
+			case 'k':
+				slot = atoi(optarg);
+				break;
+			case 'd':
+				des = true;
+				break;
+			case 'g':
+				pageCount = strtoul(optarg, NULL, 10);
+				break;
+			case 'z':
+				pageSize = strtoul(optarg, NULL, 10);
+				break;
+			case 'w':
+				gen = optarg;
+				break;
+			case 'W':
+				writePct = strtoul(optarg, NULL, 10);
+				break;
+			default:
+				fprintf(stderr, "Child: Invalid option.\n");
+				exit(1);
+		}
+	}
+	if (useRing && slot < 0)
+	{
+		fprintf(stderr, "Child: Ring transport requires a slot.\n");
+		exit(1);
+	}
+	if (pageCount == 0 || pageSize == 0)
+	{
+		fprintf(stderr, "Child: Address space must have at least 1 page of 1 byte.\n");
+		exit(1);
+	}
+
+	// Set up reference generator
+	refConfig_t cfg;
+	if (!refParse(gen, &cfg))
+	{
+		fprintf(stderr, "Child: Invalid generator %s.\n", gen);
+		exit(1);
+	}
+	refConfigure(&cfg, pageSize, pageCount, writePct);
+
 	shareMem();
+	if (useRing)
+	{
+		shareRing();
+		ringSpin = ringSpinLimit();
+	}
 	
 	// Info needed for message sending/receiving
 	msgbuffer buf;
 	msgbuffer rcvbuf;
 	buf.mtype = 1;
 	buf.pid = getpid();
-	int msqid = 0;
+	buf.terminating = false;
 	key_t key;
 
 	// Get key for message queue
@@ -104,73 +248,70 @@ int main(int argc, char* argv[])
 		exit(1);
 	}
 
-	// Represents time process started in ns
-	long long startTimeNs = (long long)shm_ptr[0] * 1000000000 + shm_ptr[1];
-	long long lastTermChk = startTimeNs;
+	// Start reference stream at current time, seeding it from pid so every worker makes different requests
+	refState_t st;
+	long long startTimeNs = clockNow();
+	refInit(&st, getpid(), startTimeNs, &cfg);
 
-	// Randomly generate a number within bound ns to determine when worker will act 
-	srand(getpid());
-	long long nAct = startTimeNs + (rand() % BOUND_NS);
+	// In discrete event mode, oss owns the clock. The worker tells oss when it will make its next request and sleeps
+	// until it is granted, then uses the grant time as its current time.
+	while (des)
+	{
+		// Determine if worker should terminate at time of next act, same as when polling the clock
+		if (refCheckTerm(&st, st.nAct))
+		{
+			// Tell oss this worker will make no more requests, then exit
+			buf.terminating = true;
+			buf.actNs = st.nAct;
+			sendRequest(&buf);
+			detachAndExit();
+		}
+
+		// Randomly generate address and read or write, same as when polling the clock
+		refNext(&st, &buf.address, &buf.isWrite);
+		buf.granted = false;
+		buf.actNs = st.nAct;
+
+		// Send request and sleep until it is granted
+		unsigned seen = sendRequest(&buf);
+		waitReply(seen, &rcvbuf);
+
+		// Randomly generate time for next act after grant
+		refSchedule(&st, rcvbuf.actNs);
+	}
 
 	while(true)
 	{
 		// Calculate current system time in ns
-		long long currTimeNs = (long long)shm_ptr[0] * 1000000000 + shm_ptr[1];
+		long long currTimeNs = clockNow();
 
-		// Determine if worker should terminate every time it reaches term check (25000000 ns)
-		if (currTimeNs - lastTermChk >= TERM_CHECK_NS)
+		// Determine if worker should terminate every time it reaches term check (250000000 ns)
+		if (refCheckTerm(&st, currTimeNs))
 		{
-			lastTermChk = currTimeNs;
-			// Once lifetime (1 sec)  is reached, worker will determine if it should terminate
-			if (currTimeNs - startTimeNs >= LIFE_NS)
-			{
-				// Randomly generate number up to 100 to determine if worker will terminate
-				int die = rand() % 100;
-				// If randomly generated number is less than term probability (40), it will terminate
-				if (die < TERM_PROB)
-				{
-					// Detach from shared memory and exit
-					if (shmdt(shm_ptr) == -1)
-					{
-						perror("shmdt failed");
-						exit(1);
-					}
-					exit(0);
-				}
-			}
+			// Detach from shared memory and exit
+			detachAndExit();
 		}
 
 		// Determine if current time has reached time for worker to act
-		if (currTimeNs >= nAct)
+		if (currTimeNs >= st.nAct)
 		{
-
-			// Randomly generate address within allowed range
-			buf.address = rand() % 32768;
-			// Randomly determine if process will request read or write
-			buf.isWrite = rand() % 2;
+			// Randomly generate address within allowed range, and whether process will request read or write
+			refNext(&st, &buf.address, &buf.isWrite);
 			// Clear granted flag before sending
 			buf.granted = false;
 
 			// Send message to oss
-			if (msgsnd(msqid, &buf, sizeof(buf) - sizeof(long), 0) == -1)
-			{
-				perror("child msgsnd");
-				exit(1);
-			}
+			unsigned seen = sendRequest(&buf);
 			// Add overhead for sending message
 			addTime();
 
 			// Wait to receive message back from oss
-			if (msgrcv(msqid, &rcvbuf, sizeof(rcvbuf) - sizeof(long), getpid(), 0) == -1)
-			{
-				perror("child msgrcv");
-				exit(1);
-			}
+			waitReply(seen, &rcvbuf);
 			// Add overhead for receiving message
 			addTime();
 
 			// Randomly generate time for next act
-			nAct = currTimeNs + (rand() % BOUND_NS);
+			refSchedule(&st, currTimeNs);
 		}
 	}
 